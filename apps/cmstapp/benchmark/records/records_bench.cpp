@@ -0,0 +1,200 @@
+/**************************** records_bench.cpp **********************
+
+Micro-benchmark comparing the two ways of decoding a GetServices reply.
+The old way demarshalled the reply into a list of arrayElements with
+getArray() and then extracted the nested dictionaries each time a
+property was read.  The new way decodes the reply straight into
+ServiceRecords.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QtTest/QtTest>
+# include <QtDBus/QtDBus>
+
+# include "./code/store/records.h"
+# include "./code/shared/shared.h"
+
+// number of services in the fake reply, a busy wifi neighbourhood
+# define SERVICE_COUNT 64
+
+# define BENCH_SERVICE "org.cmst.RecordsBench"
+# define BENCH_PATH "/"
+
+//
+// The object answering GetServices, registered on its own connection so
+// the reply really goes through the bus
+class FakeManager : public QObject
+{
+   Q_OBJECT
+   Q_CLASSINFO("D-Bus Interface", "net.connman.Manager")
+
+   public:
+      FakeManager(QObject* parent = 0);
+
+   public slots:
+      QList<arrayElement> GetServices();
+
+   private:
+      QList<arrayElement> services;
+};
+
+//
+// The benchmarks
+class RecordsBench : public QObject
+{
+   Q_OBJECT
+
+   private:
+      QDBusMessage reply;
+
+   private slots:
+      void initTestCase();
+      void getArray();
+      void records();
+};
+
+////////////////////////////////////////////////// FakeManager //////////////////////////////////////
+//
+// constructor, build services that look like the ones connman sends
+FakeManager::FakeManager(QObject* parent) : QObject(parent)
+{
+   for (int i = 0; i < SERVICE_COUNT; ++i) {
+      QMap<QString,QVariant> ipv4;
+      ipv4.insert("Method", "dhcp");
+      ipv4.insert("Address", QString("192.168.1.%1").arg(i + 2) );
+      ipv4.insert("Netmask", "255.255.255.0");
+      ipv4.insert("Gateway", "192.168.1.1");
+
+      QMap<QString,QVariant> ethernet;
+      ethernet.insert("Method", "auto");
+      ethernet.insert("Interface", "wlan0");
+      ethernet.insert("Address", QString("00:11:22:33:44:%1").arg(i, 2, 16, QChar('0')) );
+      ethernet.insert("MTU", QVariant::fromValue<quint16>(1500) );
+
+      QMap<QString,QVariant> proxy;
+      proxy.insert("Method", "direct");
+
+      arrayElement ae;
+      ae.objpath = QDBusObjectPath(QString("/net/connman/service/wifi_001122334455_%1_managed_psk").arg(i) );
+      ae.objmap.insert("Type", "wifi");
+      ae.objmap.insert("Name", QString("Network %1").arg(i) );
+      ae.objmap.insert("State", i == 0 ? "online" : "idle");
+      ae.objmap.insert("Strength", QVariant::fromValue<quint8>(100 - i) );
+      ae.objmap.insert("Security", QStringList() << "psk" << "wps");
+      ae.objmap.insert("Favorite", i < 4);
+      ae.objmap.insert("Immutable", false);
+      ae.objmap.insert("AutoConnect", i < 4);
+      ae.objmap.insert("Error", "");
+      ae.objmap.insert("Nameservers", QStringList() << "192.168.1.1");
+      ae.objmap.insert("Domains", QStringList() << "lan");
+      ae.objmap.insert("IPv4", ipv4);
+      ae.objmap.insert("IPv4.Configuration", ipv4);
+      ae.objmap.insert("Ethernet", ethernet);
+      ae.objmap.insert("Proxy", proxy);
+      ae.objmap.insert("Proxy.Configuration", proxy);
+      services.append(ae);
+   } // for
+}
+
+QList<arrayElement> FakeManager::GetServices()
+{
+   return services;
+}
+
+////////////////////////////////////////////////// RecordsBench /////////////////////////////////////
+//
+// Slot to get one real reply to decode in the benchmarks.  The server is
+// in this thread so the call has to keep the event loop running.
+void RecordsBench::initTestCase()
+{
+   registerRecordTypes();
+
+   QDBusConnection server = QDBusConnection::connectToBus(QDBusConnection::SessionBus, "records_bench_server");
+   if (! server.isConnected() ) QSKIP("No session bus, run under dbus-run-session");
+   QVERIFY(server.registerService(BENCH_SERVICE) );
+   QVERIFY(server.registerObject(BENCH_PATH, new FakeManager(this), QDBusConnection::ExportAllSlots) );
+
+   QDBusMessage call = QDBusMessage::createMethodCall(BENCH_SERVICE, BENCH_PATH, "net.connman.Manager", "GetServices");
+   reply = QDBusConnection::sessionBus().call(call, QDBus::BlockWithGui);
+   QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+   QVERIFY(reply.arguments().at(0).canConvert<QDBusArgument>() );
+}
+
+//
+// The old way.  Demarshal into arrayElements, then read the properties
+// the status page, the tray icon and the details page used.  The nested
+// dictionaries were extracted again every time they were read.
+void RecordsBench::getArray()
+{
+   int online = 0;
+   QBENCHMARK {
+      QList<arrayElement> list;
+      const QDBusArgument& qdb_arg = reply.arguments().at(0).value<QDBusArgument>();
+      qdb_arg.beginArray();
+      while (! qdb_arg.atEnd() ) {
+         arrayElement ael;
+         qdb_arg.beginStructure();
+         qdb_arg >> ael.objpath >> ael.objmap;
+         qdb_arg.endStructure();
+         list.append(ael);
+      } // while
+      qdb_arg.endArray();
+
+      for (int i = 0; i < list.size(); ++i) {
+         const QMap<QString,QVariant>& map = list.at(i).objmap;
+         if (map.value("State").toString() == "online") ++online;
+         map.value("Type").toString();
+         map.value("Name").toString();
+         map.value("Strength").value<quint8>();
+         map.value("Security").toStringList();
+         QMap<QString,QVariant> submap;
+         shared::extractMapData(submap, map.value("IPv4") );
+         shared::extractMapData(submap, map.value("Ethernet") );
+      } // for
+   } // QBENCHMARK
+
+   QVERIFY(online > 0);
+}
+
+//
+// The new way.  Decode straight into the records, nested dictionaries
+// are extracted once.
+void RecordsBench::records()
+{
+   int online = 0;
+   QBENCHMARK {
+      QList<ServiceRecord> list;
+      const QDBusArgument& qdb_arg = reply.arguments().at(0).value<QDBusArgument>();
+      qdb_arg >> list;
+
+      for (int i = 0; i < list.size(); ++i) {
+         if (list.at(i).state == ServiceRecord::State_Online) ++online;
+      } // for
+   } // QBENCHMARK
+
+   QVERIFY(online > 0);
+}
+
+QTEST_MAIN(RecordsBench)
+# include "records_bench.moc"
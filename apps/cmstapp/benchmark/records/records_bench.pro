@@ -0,0 +1,30 @@
+#  Micro-benchmark of decoding a GetServices reply.  Not part of the
+#  normal build, build and run it by hand:
+#
+#     qmake && make && dbus-run-session ./records_bench
+#
+#  It needs a session bus, the reply is sent through it so the decoding
+#  works on a real demarshalled message.
+CONFIG += qt
+CONFIG += warn_on
+CONFIG += release
+CONFIG += testcase
+
+QT += widgets
+QT += dbus
+QT += testlib
+
+TEMPLATE = app
+TARGET = records_bench
+
+# the application sources include each other relative to apps/cmstapp
+INCLUDEPATH += $$PWD/../..
+
+HEADERS += ../../code/store/records.h
+HEADERS += ../../code/shared/shared.h
+HEADERS += ../../code/trstring/tr_strings.h
+
+SOURCES += ./records_bench.cpp
+SOURCES += ../../code/store/records.cpp
+SOURCES += ../../code/shared/shared.cpp
+SOURCES += ../../code/trstring/tr_strings.cpp
@@ -28,6 +28,13 @@ DBUS_ADAPTORS 	+= ./code/agent/org.monkey_business_enterprises.agent.xml
 DBUS_INTERFACES	+= ./code/agent/org.monkey_business_enterprises.agent.xml
 DBUS_ADAPTORS 	+= ./code/counter/org.monkey_business_enterprises.counter.xml
 DBUS_INTERFACES	+= ./code/counter/org.monkey_business_enterprises.counter.xml
+DBUS_INTERFACES	+= ./code/proxycache/net.connman.manager.xml
+DBUS_INTERFACES	+= ./code/proxycache/net.connman.service.xml
+DBUS_INTERFACES	+= ./code/proxycache/net.connman.technology.xml
+DBUS_INTERFACES	+= ./code/proxycache/net.connman.vpnmanager.xml
+DBUS_INTERFACES	+= ./code/proxycache/net.connman.vpnconnection.xml
+#  the connman proxies return arrays of arrayElement structures
+QDBUSXML2CPP_INTERFACE_HEADER_FLAGS += -i ./code/store/records.h
 
 #	header files
 HEADERS		+= ../resource.h
@@ -49,6 +56,19 @@ HEADERS		+= ./code/vpn_agent/vpnagent_interface.h
 HEADERS		+= ./code/shared/shared.h
 HEADERS		+= ./code/gen_conf_ed/gen_conf_ed.h
 HEADERS         += ./code/vpn_create/vpn_create.h
+HEADERS         += ./code/store/store.h
+HEADERS         += ./code/store/records.h
+HEADERS         += ./code/models/models.h
+HEADERS         += ./code/models/delegate.h
+HEADERS         += ./code/proxycache/proxycache.h
+HEADERS         += ./code/policy/updatepolicy.h
+HEADERS         += ./code/reconnect/reconnect.h
+HEADERS         += ./code/killswitch/killswitch.h
+HEADERS         += ./code/snapshot/snapshot.h
+HEADERS         += ./code/rategraph/ratehistory.h
+HEADERS         += ./code/rategraph/rategraph.h
+HEADERS         += ./code/traffic/traffichistory.h
+HEADERS         += ./code/quota/quota.h
 
 #	forms
 FORMS		+= ./code/control_box/ui/controlbox.ui
@@ -80,6 +100,19 @@ SOURCES	+= ./code/vpn_agent/vpnagent_interface.cpp
 SOURCES += ./code/shared/shared.cpp
 SOURCES	+= ./code/gen_conf_ed/gen_conf_ed.cpp
 SOURCES += ./code/vpn_create/vpn_create.cpp
+SOURCES += ./code/store/store.cpp
+SOURCES += ./code/store/records.cpp
+SOURCES += ./code/models/models.cpp
+SOURCES += ./code/models/delegate.cpp
+SOURCES += ./code/proxycache/proxycache.cpp
+SOURCES += ./code/policy/updatepolicy.cpp
+SOURCES += ./code/reconnect/reconnect.cpp
+SOURCES += ./code/killswitch/killswitch.cpp
+SOURCES += ./code/snapshot/snapshot.cpp
+SOURCES += ./code/rategraph/ratehistory.cpp
+SOURCES += ./code/rategraph/rategraph.cpp
+SOURCES += ./code/traffic/traffichistory.cpp
+SOURCES += ./code/quota/quota.cpp
 
 #	resource files
 RESOURCES 	+= ../../cmst.qrc
@@ -47,6 +47,11 @@ DEALINGS IN THE SOFTWARE.
 # define ERROR_CANCELED "net.connman.Agent.Error.Canceled"
 # define ERROR_LAUNCHBROWSER "net.connman.Agent.Error.LaunchBrowser"
 
+// how long a request waits for the user, the connman defaults for
+// InputRequestTimeout and BrowserLaunchTimeout
+# define INPUT_TIMEOUT (120 * 1000)
+# define BROWSER_TIMEOUT (300 * 1000)
+
 //  constructor
 ConnmanAgent::ConnmanAgent(QObject* parent)
     : QObject(parent)
@@ -55,6 +60,8 @@ ConnmanAgent::ConnmanAgent(QObject* parent)
   uiDialog = new AgentDialog(qobject_cast<QWidget *> (this) );
   input_map.clear();
   b_loginputrequest = false;
+  requests.clear();
+  connect(uiDialog, SIGNAL(finished(int)), this, SLOT(dialogFinished(int)));
   
   //  Create Adaptor and register this Agent on the system bus.  
   new AgentAdaptor(this);
@@ -74,64 +81,83 @@ void ConnmanAgent::Release()
 }
 
 // Called when an error has to be reported to the user.  Show the
-// error in a QMessageBox
+// error in a QMessageBox.  The box is not modal and the reply is delayed
+// until the user answers it, see errorFinished().
 void ConnmanAgent::ReportError(QDBusObjectPath path, QString s_error)
 {
   (void) path;
-  
-  if ( QMessageBox::warning(qobject_cast<QWidget *> (parent()), tr("Connman Error"),
+
+  this->setDelayedReply(true);
+  QMessageBox* mbox = new QMessageBox(QMessageBox::Warning, tr("Connman Error"),
     tr("Connman returned the following error:<b><center>%1</b><br>Would you like to retry?").arg(TranslateStrings::cmtr(s_error)),
-    QMessageBox::Yes | QMessageBox::No,
-    QMessageBox::No
-     ) == QMessageBox::Yes) this->sendErrorReply(ERROR_RETRY, "Going to retry the request");  
-  
-  else  return; 
+    QMessageBox::Yes | QMessageBox::No, qobject_cast<QWidget *> (parent()) );
+  mbox->setDefaultButton(QMessageBox::No);
+  mbox->setAttribute(Qt::WA_DeleteOnClose);
+  errors.insert(mbox, this->message() );
+  connect(mbox, SIGNAL(finished(int)), this, SLOT(errorFinished(int)));
+  mbox->show();
+
+  return;
 }
 
 //
 // Called when it is required to ask the user to open a website to proceed
-// with login handling
+// with login handling.  The reply is delayed until the user is done with
+// the dialog.
 void ConnmanAgent::RequestBrowser(QDBusObjectPath path, QString url)
 {
   (void) path;
-  
-  // Send the url to the dialog to have the user the necessary information, return if canceled. 
-  if (this->uiDialog->showPage1(url) == QDialog::Rejected) this->sendErrorReply(ERROR_CANCELED,"User cancelled the dialog");
-  
-  return; 
+
+  AgentRequest req;
+  req.page = 1;
+  req.url = url;
+  this->queueRequest(req, BROWSER_TIMEOUT);
+
+  return;
 }
 
 //
 // Called when trying to connect to a service and some extra input is required from the user
 // A dialog is displayed with the required fields enabled (non-required fields are disabled).
+// The dialog is not modal and the reply is delayed until the user is done with it, so
+// nothing else waits on the user and each request keeps its own timeout.
 QVariantMap ConnmanAgent::RequestInput(QDBusObjectPath path, QMap<QString,QVariant> dict)
 {
   (void) path;
-  
+
   // Take the dict returned by DBus and extract the information we are interested in and place in input_map.
   this->createInputMap(dict);
-  
-  // Send our input_map to the dialog to have the user supply the necessary information
-  // needed to continue.  Return if canceled. 
-  QMap<QString,QVariant> rtn;
-  rtn.clear();
-  if (this->uiDialog->showPage0(input_map) == QDialog::Rejected) 
-   this->sendErrorReply(ERROR_CANCELED,"User cancelled the dialog");  
-  else
-    uiDialog->createDict(rtn);  // create a return dict and send it back to connman on DBus  
-  
-  return rtn;
+
+  AgentRequest req;
+  req.page = 0;
+  req.input = input_map;
+  this->queueRequest(req, INPUT_TIMEOUT);
+
+  return QVariantMap();
 }
 
 //
-// Called when the agent request failed before a reply was returned. Show
-// a QMessageBox
+// Called when the agent request failed before a reply was returned.  Close
+// the dialog for the request and tell the user.  The message box is not
+// modal either.
 void ConnmanAgent::Cancel()
 {
-  QMessageBox::information(qobject_cast<QWidget *> (parent()), tr("Agent Request Failed"),
-    tr("The agent request failed before a reply was returned.") );    
-    
-  return; 
+  // connman has already dropped the request, so it gets no reply.  Hiding
+  // the dialog does not emit finished(), dialogFinished() is not called.
+  if (! requests.isEmpty() ) {
+    AgentRequest req = requests.takeFirst();
+    req.timer->stop();
+    req.timer->deleteLater();
+    uiDialog->hide();
+    this->showRequest();
+  } // if a request is showing
+
+  QMessageBox* mbox = new QMessageBox(QMessageBox::Information, tr("Agent Request Failed"),
+    tr("The agent request failed before a reply was returned."), QMessageBox::Ok, qobject_cast<QWidget *> (parent()) );
+  mbox->setAttribute(Qt::WA_DeleteOnClose);
+  mbox->show();
+
+  return;
 }
 
 /////////////////////////////////////// PUBLIC FUNCTIONS ////////////////////////////////
@@ -205,3 +231,103 @@ void ConnmanAgent::createInputMap(const QMap<QString,QVariant>& r_map)
   return; 
 }
 
+/////////////////////////////////////// PRIVATE FUNCTIONS ////////////////////////////////
+//
+// Function to take over the DBus message being handled and queue the
+// request.  Requests are shown one at a time in the order they arrived.
+void ConnmanAgent::queueRequest(AgentRequest& req, int timeout)
+{
+  this->setDelayedReply(true);
+  req.msg = this->message();
+  req.timer = new QTimer(this);
+  req.timer->setSingleShot(true);
+  connect(req.timer, SIGNAL(timeout()), this, SLOT(requestTimedOut()));
+  req.timer->start(timeout);
+
+  requests.append(req);
+  if (requests.count() == 1) this->showRequest();
+
+  return;
+}
+
+//
+// Function to show the dialog for the request at the head of the queue
+void ConnmanAgent::showRequest()
+{
+  if (requests.isEmpty() ) return;
+
+  if (requests.first().page == 1)
+    uiDialog->showPage1(requests.first().url);
+  else
+    uiDialog->showPage0(requests.first().input);
+
+  return;
+}
+
+/////////////////////////////////////// PRIVATE SLOTS ////////////////////////////////
+//
+// Slot called when the dialog is closed.  Send the reply for the request
+// at the head of the queue and show the next one.
+void ConnmanAgent::dialogFinished(int result)
+{
+  if (requests.isEmpty() ) return;
+  AgentRequest req = requests.takeFirst();
+  req.timer->deleteLater();
+
+  QDBusMessage reply;
+  if (result == QDialog::Rejected)
+    reply = req.msg.createErrorReply(ERROR_CANCELED, "User cancelled the dialog");
+  else if (req.page == 1)
+    reply = req.msg.createReply();
+  else {
+    QMap<QString,QVariant> rtn;
+    uiDialog->createDict(rtn);  // create a return dict and send it back to connman on DBus
+    reply = req.msg.createReply(QVariant(rtn) );
+  } // else input accepted
+  QDBusConnection::systemBus().send(reply);
+
+  this->showRequest();
+
+  return;
+}
+
+//
+// Slot called when a request has waited too long.  Connman has given up on
+// it by now.  If it is showing close the dialog, otherwise just drop it.
+void ConnmanAgent::requestTimedOut()
+{
+  QTimer* timer = qobject_cast<QTimer*>(sender() );
+  for (int i = 0; i < requests.count(); ++i) {
+    if (requests.at(i).timer != timer) continue;
+    if (i == 0) {
+      uiDialog->reject();
+    }
+    else {
+      QDBusConnection::systemBus().send(requests.at(i).msg.createErrorReply(ERROR_CANCELED, "Request timed out") );
+      timer->deleteLater();
+      requests.removeAt(i);
+    }
+    break;
+  } // for
+
+  return;
+}
+
+//
+// Slot called when the user answers an error box.  Ask connman to retry
+// if the user said yes, otherwise just acknowledge the error.
+void ConnmanAgent::errorFinished(int result)
+{
+  (void) result;
+
+  QMessageBox* mbox = qobject_cast<QMessageBox*>(sender() );
+  if (! errors.contains(mbox) ) return;
+  const QDBusMessage msg = errors.take(mbox);
+
+  if (mbox->standardButton(mbox->clickedButton()) == QMessageBox::Yes)
+    QDBusConnection::systemBus().send(msg.createErrorReply(ERROR_RETRY, "Going to retry the request") );
+  else
+    QDBusConnection::systemBus().send(msg.createReply() );
+
+  return;
+}
@@ -37,6 +37,11 @@ DEALINGS IN THE SOFTWARE.
 # include <QVariantMap>
 # include <QtDBus/QDBusObjectPath>
 # include <QtDBus/QDBusContext>
+# include <QtDBus/QDBusMessage>
+# include <QList>
+# include <QHash>
+# include <QTimer>
+# include <QMessageBox>
 
 # include "./code/agent/agent_dialog.h"
 
@@ -44,6 +49,18 @@ DEALINGS IN THE SOFTWARE.
 # define AGENT_INTERFACE "net.connman.Agent"
 # define AGENT_OBJECT "/org/cmst/Agent"
 
+//
+// A request from connman waiting for the user.  The reply is sent when
+// the dialog is finished or the request times out.
+struct AgentRequest
+{
+   QDBusMessage msg;
+   int page;                        // dialog page, 0 for input, 1 for the browser
+   QMap<QString,QString> input;     // fields for page 0
+   QString url;                     // url for page 1
+   QTimer* timer;
+};
+
 class ConnmanAgent : public QObject, protected QDBusContext
 {
    Q_OBJECT
@@ -66,8 +83,17 @@ class ConnmanAgent : public QObject, protected QDBusContext
       AgentDialog* uiDialog;
       QMap<QString,QString> input_map;
       bool b_loginputrequest;
+      QList<AgentRequest> requests;
+      QHash<QMessageBox*, QDBusMessage> errors;
 
       void createInputMap(const QMap<QString,QVariant>&);
+      void queueRequest(AgentRequest&, int);
+      void showRequest();
+
+   private slots:
+      void dialogFinished(int);
+      void requestTimedOut();
+      void errorFinished(int);
 
    public:
       inline void setWhatsThisIcon(QIcon icon) {uiDialog->setWhatsThisIcon(icon); }
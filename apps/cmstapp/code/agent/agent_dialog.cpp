@@ -75,8 +75,9 @@ AgentDialog::AgentDialog(QWidget* parent)
 //
 //	Function to show page 0 of the stackWidget
 //	imap - is map of QStrings with input keys that connman has requested the user to fill in, and any values
-//	that it has sent back for informational purposes.  Return the accept state of the dialog
-int AgentDialog::showPage0(const QMap<QString,QString>& imap)
+//	that it has sent back for informational purposes.  The dialog is not modal, the result
+//	comes back with the finished() signal.
+void AgentDialog::showPage0(const QMap<QString,QString>& imap)
 {
 	// set all input widgets to disabled
 	this->initialize();
@@ -118,14 +119,18 @@ int AgentDialog::showPage0(const QMap<QString,QString>& imap)
 	} 	
 	
 	this->ui.stackedWidget->setCurrentIndex(0);
-	return this->exec();
+	this->show();
+	this->raise();
+	this->activateWindow();
+
+	return;
 }
 
 //
 //	Function to show page 1 of the stackWidget
 //	url - is the url that the user needs to open
-//	Return the accept state of the dialog
-int AgentDialog::showPage1(const QString& url)
+//	The dialog is not modal, the result comes back with the finished() signal.
+void AgentDialog::showPage1(const QString& url)
 {
 	// set all input widgets to disabled
 	this->initialize();	
@@ -152,7 +157,11 @@ int AgentDialog::showPage1(const QString& url)
 	ui.listView_browsers->setEnabled(true);
 	
 	this->ui.stackedWidget->setCurrentIndex(1);
-	return this->exec();	
+	this->show();
+	this->raise();
+	this->activateWindow();
+
+	return;
 }
 
 //
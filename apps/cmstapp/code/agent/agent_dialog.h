@@ -47,8 +47,8 @@ class AgentDialog : public QDialog
       AgentDialog(QWidget*);
 
       // functions
-      int showPage0(const QMap<QString,QString>&);
-      int showPage1(const QString&);
+      void showPage0(const QMap<QString,QString>&);
+      void showPage1(const QString&);
       void createDict(QMap<QString,QVariant>&);
 
    private:
@@ -39,8 +39,8 @@ DEALINGS IN THE SOFTWARE.
 
 # include <QDBusArgument>
 
-# include <QTableWidget>
-# include <QTableWidgetItem>
+# include <QTableView>
+# include <QHeaderView>
 # include <QFileInfo>
 # include <QFile>
 # include <QWhatsThis>
@@ -48,9 +48,9 @@ DEALINGS IN THE SOFTWARE.
 # include <QPixmap>
 # include <QMessageBox>
 # include <QCloseEvent>
+# include <QShowEvent>
 # include <QKeyEvent>
 # include <QToolTip>
-# include <QTableWidgetSelectionRange>
 # include <QProcess>
 # include <QProcessEnvironment>
 # include <QLocale>
@@ -80,48 +80,18 @@ DEALINGS IN THE SOFTWARE.
 # define DBUS_CON_SERVICE "net.connman"
 # define DBUS_VPN_SERVICE "net.connman.vpn"
 # define DBUS_CON_MANAGER "net.connman.Manager"
-# define DBUS_VPN_MANAGER "net.connman.vpn.Manager"
 
 # define VPN_PATH "/var/lib/connman-vpn"
 
-// Custom push button, used in the technology box for powered on/off
-// This is really a single use button, after it is clicked all idButtons
-// are deleted and recreated.  Once is is clicked disable the button.
-idButton::idButton(QWidget* parent, const QDBusObjectPath& id) :
-      QFrame(parent)
-{
-   // margins
-   const int m_left = 5;
-   const int m_top = 0;
-   const int m_right = 5;
-   const int m_bottom = 0;
-
-   // create the button
-   button = new QToolButton(this);
-   button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
-   obj_id = id;
-   button->setCheckable(true);
-   button->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-   connect (button, SIGNAL(clicked(bool)), this, SLOT(buttonClicked(bool)));
-
-   // create the box
-   QHBoxLayout* layout = new QHBoxLayout(this);
-   layout->setContentsMargins(m_left, m_top, m_right, m_bottom);
-   layout->setAlignment(Qt::AlignCenter);
-   layout->addWidget(button, 0);
-
-   return;
-}
-
-
-void idButton::buttonClicked(bool checked)
-{
-   this->setDisabled(true);
+// milliseconds between saves of the store snapshot
+# define SNAPSHOT_INTERVAL (5 * 60 * 1000)
 
-   emit clickedID (obj_id.path(), checked);
+// milliseconds between compactions of the traffic history
+# define TRAFFIC_INTERVAL (15 * 60 * 1000)
 
-   return;
-}
+// fixed entries at the top of ui.comboBox_counterservice
+# define COUNTER_ONLINE 0
+# define COUNTER_ALL 1
 
 // main GUI element
 ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
@@ -136,18 +106,26 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    // set the window title
    setWindowTitle(TranslateStrings::cmtr("connman system tray"));
 
+   // time the startup, logged once connman has answered all of our queries
+   startup_timer.start();
+   startup_pending = 0;
+   scans_pending = 0;
+   startup_ctor_ms = 0;
+   b_resync = false;
+   b_counters = false;
+   connman_watcher = NULL;
+
    // data members
    q16_errors = CMST::No_Errors;
-   properties_map.clear();
-   services_list.clear();
-   technologies_list.clear();
-   wifi_list.clear();
-   peer_list.clear();
-   vpn_list.clear();
-   vpnconn_list.clear();
    agent = new ConnmanAgent(this);
    vpnagent = new ConnmanVPNAgent(this);
    counter = new ConnmanCounter(this);
+   registerRecordTypes();
+   proxies = new ProxyCache(QDBusConnection::systemBus(), this);
+   reconnector = new ReconnectScheduler(&store, proxies, this);
+   killswitch = new KillSwitch(&store, proxies, this);
+   quotas = new QuotaEngine(&traffic, proxies, this);
+   quotapath.clear();
    trayiconmenu = new QMenu(this);
    tech_submenu = new QMenu(tr("Technologies"), this);
    info_submenu = new QMenu(tr("Service Details"), this);
@@ -169,6 +147,18 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    iconman = new IconManager(this);
    b_userinitiated = false;
    iconscale = 1.0;
+   q16_dirty = CMST::Page_None;
+   q16_stale = CMST::Page_None;
+   redraw_timer = new QTimer(this);
+   redraw_timer->setSingleShot(true);
+   counter_timer = new QTimer(this);
+   counter_timer->setSingleShot(true);
+   b_counterpending = false;
+   b_snapshot = false;
+   snapshot_timer = new QTimer(this);
+   snapshot_timer->setInterval(SNAPSHOT_INTERVAL);
+   traffic_timer = new QTimer(this);
+   traffic_timer->setInterval(TRAFFIC_INTERVAL);
 
    // set a stylesheet on the tab widget - used to hide disabled tabs
    QFile f0(":/stylesheets/stylesheets/tabwidget.qss");
@@ -276,6 +266,44 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    agent->setIconSize(iconscale);
    vpnagent->setIconSize(iconscale);
 
+   // Models and delegates for the tables.  The toggle buttons in the
+   // technologies table each get their own delegate so a click goes to
+   // the right slot.
+   technology_model = new TechnologyModel(&store, iconman, this);
+   technology_model->setHeaders(QStringList() << tr("Name") << tr("Type") << tr("Powered") << tr("Connected") << tr("Tethering") << tr("ID:Password") );
+   service_model = new ServiceModel(&store, iconman, this);
+   service_model->setHeaders(QStringList() << tr("Name") << tr("Type") << tr("State") << tr("Connection") );
+   wifi_model = new WifiModel(&store, iconman, this);
+   wifi_model->setHeaders(QStringList() << tr("Name") << tr("Favorite") << tr("Connected") << tr("Security") << tr("Signal Strength") );
+   vpn_model = new VPNModel(&store, iconman, this);
+   vpn_model->setHeaders(QStringList() << tr("Name") << tr("Type") << tr("State") << tr("Host") << tr("Connection") );
+   service_model->trackChanges(true);
+   wifi_model->trackChanges(true);
+   vpn_model->trackChanges(true);
+   technology_model->setIconScale(iconscale);
+   service_model->setIconScale(iconscale);
+   wifi_model->setIconScale(iconscale);
+   vpn_model->setIconScale(iconscale);
+   ui.tableView_technologies->setModel(technology_model);
+   ui.tableView_services->setModel(service_model);
+   ui.tableView_wifi->setModel(wifi_model);
+   ui.tableView_vpn->setModel(vpn_model);
+
+   delegate = new StoreDelegate(this);
+   delegate->setHighlight(QColor(ui.lineEdit_colorize->text()) );
+   ui.tableView_wifi->setItemDelegate(delegate);
+   ui.tableView_vpn->setItemDelegate(delegate);
+   StoreDelegate* powered_delegate = new StoreDelegate(this);
+   StoreDelegate* tethered_delegate = new StoreDelegate(this);
+   ui.tableView_technologies->setItemDelegateForColumn(2, powered_delegate);
+   ui.tableView_technologies->setItemDelegateForColumn(4, tethered_delegate);
+   connect(powered_delegate, SIGNAL(toggled(QString, bool)), this, SLOT(togglePowered(QString, bool)));
+   connect(tethered_delegate, SIGNAL(toggled(QString, bool)), this, SLOT(toggleTethered(QString, bool)));
+
+   // rate graph on the counters page
+   rategraph = new RateGraph(ui.groupBox_rate_counter);
+   ui.verticalLayout_rategraph->addWidget(rategraph);
+
    // Fake transparency
    if (parser.isSet("fake-transparency") ) {
       bool ok;
@@ -315,6 +343,24 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    }
    counter_period = setval > minval ? setval : minval; // number of seconds for counter updates
 
+   // Changes signaled by connman are collected for this long before the
+   // display is redrawn.  Zero means redraw as soon as the event loop is idle.
+   bool b_ok = false;
+   int redraw_interval = parser.value("redraw-interval").toInt(&b_ok, 10);
+   if (! b_ok || redraw_interval < 0) redraw_interval = 16;
+   redraw_timer->setInterval(redraw_interval);
+
+   // Signal strength changes smaller than this are not redrawn unless they
+   // move the signal to a different icon.
+   int strength_delta = parser.value("strength-delta").toInt(&b_ok, 10);
+   if (b_ok && strength_delta >= 0) policy.setStrengthDelta(strength_delta);
+
+   // The counters page is redrawn at most once in this many milliseconds no
+   // matter how often connman sends counter updates.
+   int counter_refresh = parser.value("counter-refresh").toInt(&b_ok, 10);
+   if (! b_ok || counter_refresh < 0) counter_refresh = 1000;
+   counter_timer->setInterval(counter_refresh);
+
    // Hide the minimize button requested
    if (parser.isSet("disable-minimize") ? true : (b_so && ui.checkBox_disableminimized->isChecked()) )
       ui.pushButton_minimize->hide();
@@ -335,99 +381,76 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    QTimer::singleShot(2 * 1000, this, SLOT(connectNotifyClient()));
    QTimer::singleShot(8 * 1000, this, SLOT(connectNotifyClient()));
 
-   // setup the dbus interface to connman.manager
+   // setup the dbus interfaces to connman.manager and connman-vpn.manager.  All of
+   // the startup queries are sent at once without waiting for replies.  The replies
+   // are processed in the startupXX() slots as they arrive.
    con_manager = NULL;
    vpn_manager = NULL;
    if (! QDBusConnection::systemBus().isConnected() ) logErrors(CMST::Err_No_DBus);
    else {
-      con_manager = new QDBusInterface(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, QDBusConnection::systemBus(), this);
-      if (! con_manager->isValid() ) logErrors(CMST::Err_Invalid_Con_Iface);
+      con_manager = new NetConnmanManagerInterface(DBUS_CON_SERVICE, DBUS_PATH, QDBusConnection::systemBus(), this);
+
+      // Show the last known state until connman answers the startup queries.
+      // The replies replace it in place as they arrive.  The kill switch is
+      // not synced from the snapshot, it only arms on a VPN that is up in
+      // this session (see startupServices() and dbsServicesChanged()).
+      b_snapshot = snapshot.load(store);
+
+      // Reset the getXX errors
+      q16_errors &= ~CMST::Err_Properties;
+      q16_errors &= ~CMST::Err_Technologies;
+      q16_errors &= ~CMST::Err_Services;
+
+      // connect some dbus signals to our slots.  Do it before the queries go out so
+      // we don't miss anything that changes between the query and the reply.
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbsPropertyChanged(QString, QDBusVariant)));
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbsTechnologyAdded(QDBusObjectPath, QVariantMap)));
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbsTechnologyRemoved(QDBusObjectPath)));
+
+      // One connection each for the PropertyChanged signals of every service, technology and vpn
+      // connection.  The path is left empty so the match rule covers all objects and we don't have
+      // to add and remove rules as objects come and go. The slots find the object from msg.path().
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, QString(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
+      QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, QString(), "net.connman.Technology", "PropertyChanged", this, SLOT(dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage)));
+
+      // Access connman.manager to retrieve the data and register the agent, and
+      // the counter if counters are enabled
+      b_counters = parser.isSet("enable-counters") ? true : (b_so && ui.checkBox_enablecounters->isChecked());
+      this->queryConnman();
+      if (! b_counters) ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.Counters), false);
+
+      // clear the counters if selected
+      this->clearCounters();
+
+      // find the connman version we are running
+      findConnmanVersion();
+
+      // VPN manager. Disable vpn options if commandline or option is set
+      if (parser.isSet("disable-vpn") ? true : (b_so && ui.checkBox_disablevpn->isChecked()) ) {
+         ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
+         ui.pushButton_vpn_editor->setDisabled(true);
+         ui.checkBox_killswitch->setDisabled(true);
+      } // if parser set
       else {
-         // Access connman.manager to retrieve the data
-
-         // Reset the getXX errors
-         q16_errors &= ~CMST::Err_Properties;
-         q16_errors &= ~CMST::Err_Technologies;
-         q16_errors &= ~CMST::Err_Services;
-
-         if (! getTechnologies() ) logErrors(CMST::Err_Technologies);
-         else {
-            // connect technology signals to slots
-            for (int i = 0; i < technologies_list.size(); ++i) {
-               QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, technologies_list.at(i).objpath.path(), "net.connman.Technology", "PropertyChanged", this, SLOT(dbsTechnologyPropertyChanged(QString, QDBusVariant, QDBusMessage)));
-            } // for
-         } //else
-
-         if (! getServices() ) logErrors(CMST::Err_Services);
-         else {
-            // connect service signals to slots
-            for (int i = 0; i < services_list.size(); ++i) {
-               QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, services_list.at(i).objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-            } // for
-         } // else
-
-         if (! getProperties() ) logErrors(CMST::Err_Properties);
-
-         // register the agent
-         shared::processReply(con_manager->call(QDBus::AutoDetect, "RegisterAgent", QVariant::fromValue(QDBusObjectPath(AGENT_OBJECT))) );
-
-         // if counters are enabled connect signal to slot and register the counter
-         if (parser.isSet("enable-counters") ? true : (b_so && ui.checkBox_enablecounters->isChecked()) ) {
-            QList<QVariant> vlist_counter;
-            vlist_counter.clear();
-            vlist_counter << QVariant::fromValue(QDBusObjectPath(CNTR_OBJECT)) << counter_accuracy << counter_period;
-            QDBusMessage reply = con_manager->callWithArgumentList(QDBus::AutoDetect, "RegisterCounter", vlist_counter);
-            if (shared::processReply(reply) == QDBusMessage::ReplyMessage)
-               connect(counter, SIGNAL(usageUpdated(QDBusObjectPath, QString, QString)), this, SLOT(counterUpdated(QDBusObjectPath, QString, QString)));
-         } // enable counters
-         else {
-         ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.Counters), false);
-         }
-
-         // connect some dbus signals to our slots
-         QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PropertyChanged", this, SLOT(dbsPropertyChanged(QString, QDBusVariant)));
-         QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "ServicesChanged", this, SLOT(dbsServicesChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-         QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "PeersChanged", this, SLOT(dbsPeersChanged(QList<QVariant>, QList<QDBusObjectPath>, QDBusMessage)));
-         QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyAdded", this, SLOT(dbsTechnologyAdded(QDBusObjectPath, QVariantMap)));
-         QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, DBUS_PATH, DBUS_CON_MANAGER, "TechnologyRemoved", this, SLOT(dbsTechnologyRemoved(QDBusObjectPath)));
-
-         // clear the counters if selected
-         this->clearCounters();
-
-         // find the connman version we are running
-         findConnmanVersion();
-
-         // VPN manager. Disable vpn options if commandline or option is set
-         if (parser.isSet("disable-vpn") ? true : (b_so && ui.checkBox_disablevpn->isChecked()) ) {
-            ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
-            ui.pushButton_vpn_editor->setDisabled(true);
-            ui.checkBox_killswitch->setDisabled(true);
-         } // if parser set
-         else {
-            vpn_manager = new QDBusInterface(DBUS_VPN_SERVICE, DBUS_PATH, DBUS_VPN_MANAGER, QDBusConnection::systemBus(), this);
-            if (! vpn_manager->isValid() ) {
-               ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
-               ui.pushButton_vpn_editor->setDisabled(true);
-               ui.checkBox_killswitch->setDisabled(true);
-               logErrors(CMST::Err_Invalid_VPN_Iface);
-            }
-            else {
-               ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), true);
-               ui.pushButton_vpn_editor->setEnabled(true);
-               ui.checkBox_killswitch->setEnabled(true);
-               shared::processReply(vpn_manager->call(QDBus::AutoDetect, "RegisterAgent", QVariant::fromValue(QDBusObjectPath(VPN_AGENT_OBJECT))) );
-
-               // connect vpn services to slots
-               QDBusMessage reply = vpn_manager->call("GetConnections");
-               shared::processReply(reply);
-               vpnconn_list.clear();
-               getArray(vpnconn_list, reply);
-               for (int i = 0; i < vpnconn_list.size(); ++i) {
-                  QDBusConnection::systemBus().connect(DBUS_VPN_SERVICE, vpnconn_list.at(i).objpath.path(), "net.connman.vpn.Connection", "PropertyChanged", this, SLOT(dbsVPNPropertyChanged(QString, QDBusVariant, QDBusMessage)));
-               } // vpnconn_list for loop
-            } // else enable vpn widgets, register agent, connect signals
-         } // else vpn_manager is valid
-      } // else have valid connection
+         // enable the vpn widgets now, they are disabled again if connman-vpn is not on the bus
+         vpn_manager = new NetConnmanVpnManagerInterface(DBUS_VPN_SERVICE, DBUS_PATH, QDBusConnection::systemBus(), this);
+         ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), true);
+         ui.pushButton_vpn_editor->setEnabled(true);
+         ui.checkBox_killswitch->setEnabled(true);
+         QDBusConnection::systemBus().connect(DBUS_VPN_SERVICE, QString(), "net.connman.vpn.Connection", "PropertyChanged", this, SLOT(dbsVPNPropertyChanged(QString, QDBusVariant, QDBusMessage)));
+         this->queryConnmanVPN();
+      } // else vpn not disabled
+
+      // Watch for connman and connman-vpn restarting so we can register again
+      // and resynchronize without the user restarting us.
+      connman_watcher = new QDBusServiceWatcher(this);
+      connman_watcher->setConnection(QDBusConnection::systemBus() );
+      connman_watcher->setWatchMode(QDBusServiceWatcher::WatchForOwnerChange);
+      connman_watcher->addWatchedService(DBUS_CON_SERVICE);
+      if (vpn_manager != NULL) connman_watcher->addWatchedService(DBUS_VPN_SERVICE);
+      connect(connman_watcher, SIGNAL(serviceOwnerChanged(const QString&, const QString&, const QString&)), this, SLOT(connmanOwnerChanged(const QString&, const QString&, const QString&)));
    } // else have connected systemBus
 
    // add actions to groups
@@ -457,6 +480,14 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    connect(info_submenu, SIGNAL(triggered(QAction*)), this, SLOT(infoSubmenuTriggered(QAction*)));
    connect(wifi_submenu, SIGNAL(triggered(QAction*)), this, SLOT(wifiSubmenuTriggered(QAction*)));
    connect(vpn_submenu, SIGNAL(triggered(QAction*)), this, SLOT(vpnSubmenuTriggered(QAction*)));
+   connect(tech_submenu, SIGNAL(aboutToShow()), this, SLOT(submenuAboutToShow()));
+   connect(info_submenu, SIGNAL(aboutToShow()), this, SLOT(submenuAboutToShow()));
+   connect(wifi_submenu, SIGNAL(aboutToShow()), this, SLOT(submenuAboutToShow()));
+   connect(vpn_submenu, SIGNAL(aboutToShow()), this, SLOT(submenuAboutToShow()));
+   connect(tech_submenu, SIGNAL(aboutToHide()), this, SLOT(submenuAboutToHide()));
+   connect(info_submenu, SIGNAL(aboutToHide()), this, SLOT(submenuAboutToHide()));
+   connect(wifi_submenu, SIGNAL(aboutToHide()), this, SLOT(submenuAboutToHide()));
+   connect(vpn_submenu, SIGNAL(aboutToHide()), this, SLOT(submenuAboutToHide()));
    connect(exitAction, SIGNAL(triggered()), qApp, SLOT(quit()));
    connect(moveGroup, SIGNAL(triggered(QAction*)), this, SLOT(moveButtonPressed(QAction*)));
    connect(mvsrv_menu, SIGNAL(triggered(QAction*)), this, SLOT(moveService(QAction*)));
@@ -468,6 +499,13 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    // connect signals and slots - ui elements
    connect(ui.toolButton_whatsthis, SIGNAL(clicked()), this, SLOT(showWhatsThis()));
    connect(ui.comboBox_service, SIGNAL(currentIndexChanged(int)), this, SLOT(getServiceDetails(int)));
+   connect(ui.comboBox_counterservice, SIGNAL(currentIndexChanged(int)), this, SLOT(showCounters()));
+   connect(ui.comboBox_ratetier, SIGNAL(currentIndexChanged(int)), this, SLOT(showCounters()));
+   connect(ui.comboBox_usageperiod, SIGNAL(currentIndexChanged(int)), this, SLOT(showCounters()));
+   connect(ui.pushButton_quotaapply, SIGNAL(clicked()), this, SLOT(applyQuota()));
+   connect(quotas, SIGNAL(thresholdReached(QString, int, quint64, quint64)), this, SLOT(quotaThresholdReached(QString, int, quint64, quint64)));
+   connect(quotas, SIGNAL(capReached(QString, int)), this, SLOT(quotaCapReached(QString, int)));
+   connect(quotas, SIGNAL(periodStarted(QString)), this, SLOT(quotaPeriodStarted(QString)));
    connect(ui.pushButton_exit, SIGNAL(clicked()), exitAction, SLOT(trigger()));
    connect(ui.pushButton_minimize, SIGNAL(clicked()), minimizeAction, SLOT(trigger()));
    connect(ui.pushButton_connect, SIGNAL(clicked()), this, SLOT(connectPressed()));
@@ -485,9 +523,9 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(cleanUp()));
    connect(ui.pushButton_license, SIGNAL(clicked()), this, SLOT(showLicense()));
    connect(ui.pushButton_change_log, SIGNAL(clicked()), this, SLOT(showChangeLog()));
-   connect(ui.tableWidget_services, SIGNAL (cellClicked(int, int)), this, SLOT(enableMoveButtons(int, int)));
-   connect(ui.checkBox_hidecnxn, SIGNAL (toggled(bool)), this, SLOT(updateDisplayWidgets()));
-   connect(ui.checkBox_hidetethering, SIGNAL (toggled(bool)), this, SLOT(updateDisplayWidgets()));
+   connect(ui.tableView_services, SIGNAL (clicked(const QModelIndex&)), this, SLOT(enableMoveButtons(const QModelIndex&)));
+   connect(ui.checkBox_hidecnxn, SIGNAL (toggled(bool)), this, SLOT(statusOptionsChanged()));
+   connect(ui.checkBox_hidetethering, SIGNAL (toggled(bool)), this, SLOT(statusOptionsChanged()));
    connect(ui.checkBox_systemtraynotifications, SIGNAL (clicked(bool)), this, SLOT(trayNotifications(bool)));
    connect(ui.checkBox_notifydaemon, SIGNAL (clicked(bool)), this, SLOT(daemonNotifications(bool)));
    connect(ui.checkBox_hideIconFull, SIGNAL(clicked(bool)), this, SLOT(iconFullHide(bool)));
@@ -498,8 +536,22 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
    connect(socketserver, SIGNAL(newConnection()), this, SLOT(socketConnectionDetected()));
    connect(ui.checkBox_runonstartup, SIGNAL(toggled(bool)), this, SLOT(enableRunOnStartup(bool)));
    connect(ui.lineEdit_colorize, SIGNAL(textChanged(const QString&)), this, SLOT(iconColorChanged(const QString&)));
-   connect(ui.checkBox_enablesystemtraytooltips, SIGNAL(clicked()), this, SLOT(updateDisplayWidgets()));
+   connect(ui.checkBox_enablesystemtraytooltips, SIGNAL(clicked()), this, SLOT(trayOptionsChanged()));
+   connect(redraw_timer, SIGNAL(timeout()), this, SLOT(updateDisplayWidgets()));
+   connect(counter_timer, SIGNAL(timeout()), this, SLOT(counterRefresh()));
+   connect(snapshot_timer, SIGNAL(timeout()), this, SLOT(saveSnapshot()));
+   snapshot_timer->start();
+   connect(traffic_timer, SIGNAL(timeout()), this, SLOT(compactTraffic()));
+   traffic_timer->start();
+   this->compactTraffic();
+   connect(ui.tabWidget, SIGNAL(currentChanged(int)), this, SLOT(currentPageChanged()));
    connect(ui.pushButton_IDPass, SIGNAL(clicked()), this, SLOT(wifiIDPass()));
+   connect(ui.checkBox_retryfailed, SIGNAL(toggled(bool)), reconnector, SLOT(setEnabled(bool)));
+   connect(reconnector, SIGNAL(historyChanged(const QString&)), this, SLOT(reconnectHistoryChanged()));
+   reconnector->setEnabled(ui.checkBox_retryfailed->isChecked() );
+   connect(ui.checkBox_killswitch, SIGNAL(toggled(bool)), killswitch, SLOT(setEnabled(bool)));
+   connect(killswitch, SIGNAL(engaged(const QString&)), this, SLOT(killSwitchEngaged(const QString&)));
+   killswitch->setEnabled(ui.checkBox_killswitch->isChecked() );
 
    // Install an event filter on all child widgets. Used to control
    // tooltip visibility
@@ -514,7 +566,7 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
       trayicon = NULL;
       ui.checkBox_hideIconFull->setDisabled(true);
       ui.checkBox_hideIconAuto->setDisabled(true);
-      this->updateDisplayWidgets();
+      this->scheduleRedraw(CMST::Page_All);
       qApp->setQuitOnLastWindowClosed(true); // not running systemtray icon so normal close
       this->showNormal(); // no place to minimize to, so showMaximized
    } // if
@@ -538,6 +590,8 @@ ControlBox::ControlBox(const QCommandLineParser& parser, QWidget *parent)
          QTimer::singleShot(timeout, this, SLOT(createSystemTrayIcon()) );
       } // else showNormal
    } // else
+
+   startup_ctor_ms = startup_timer.elapsed();
 }
 
 ////////////////////////////////////////////////// Public Functions //////////////////////////////////
@@ -621,21 +675,42 @@ void ControlBox::showChangeLog()
 
 ////////////////////////////////////////////Private Slots ////////////////////////////////////////////
 //
-// Slot to update all of our display widgets
+// Slot to mark display pages as needing a rebuild.  Connman tends to send
+// signals in bursts (scan results, state changes on several services at once)
+// so instead of rebuilding everything on each signal we set dirty flags and
+// start the redraw timer.  The timer is not restarted if it is already
+// running, so a redraw happens at most one interval after the first change.
+void ControlBox::scheduleRedraw(quint16 pages)
+{
+   q16_dirty |= pages;
+   if (! redraw_timer->isActive() ) redraw_timer->start();
+
+   return;
+}
+
+//
+// Slot to update our display widgets.  Called when the redraw timer fires.
+// The tray icon is rebuilt if it is flagged in q16_dirty.  The pages are
+// only marked stale, the one the user is looking at is rebuilt now and the
+// others are rebuilt when they are shown.
 void ControlBox::updateDisplayWidgets()
 {
-   // each assemble function will check q16_errors to make sure it can
-   // get the information it needs. Only check for major errors since we
-   // can't run the assemble functions if there are.
+   // take the dirty flags, anything flagged while we are assembling will be
+   // picked up on the next pass
+   const quint16 pages = q16_dirty;
+   q16_dirty = CMST::Page_None;
+   q16_stale |= (pages & ~CMST::Page_TrayIcon);
+
+   // Only check for major errors since we can't run the assemble functions if there are.
    if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) == 0x00 ) {
-      // rebuild our pages
-      this->assembleTabStatus();
-      this->assembleTabDetails();
-      this->assembleTabWireless();
-      this->assembleTabVPN();
-      this->assembleTabCounters();
-      this->assembleTabPreferences();
-      if (trayicon != NULL ) {
+      // rebuild the page the user can see
+      this->assembleStalePages(this->visiblePage() );
+
+      // the rescan action is in the tray menu, keep it current even if the wireless page is stale
+      if ( (pages & CMST::Page_Wireless) && (q16_errors & CMST::Err_Services) == 0x00 )
+         setStateRescan(scans_pending == 0 && store.wifiCount() > 0);
+
+      if (trayicon != NULL && (pages & CMST::Page_TrayIcon) ) {
          this->assembleTrayIcon();
 
          bool b_dtaware = qApp->desktopSettingsAware();
@@ -646,7 +721,7 @@ void ControlBox::updateDisplayWidgets()
             if (ui.checkBox_hideIconFull->isChecked() )
                trayicon->setVisible(false);
             else {
-               if (ui.checkBox_hideIconAuto->isChecked() && ((properties_map.value("State").toString() == "online") || (properties_map.value("State").toString() == "ready")) )
+               if (ui.checkBox_hideIconAuto->isChecked() && ((store.properties().value("State").toString() == "online") || (store.properties().value("State").toString() == "ready")) )
                   trayicon->setVisible(false);
                else
                   trayicon->setVisible(true);
@@ -660,13 +735,57 @@ void ControlBox::updateDisplayWidgets()
         qApp->setDesktopSettingsAware(b_dtaware);
       } // if trayicon not NULL
 
+   } // if there were no major errors
+
+   return;
+}
+
+//
+// Function to rebuild the pages flagged in pages, but only if they are
+// stale.  Called from updateDisplayWidgets(), when the dialog is shown
+// and when the current tab changes.
+void ControlBox::assembleStalePages(quint16 pages)
+{
+   pages &= q16_stale;
+   if (pages == CMST::Page_None) return;
+
+   // each assemble function will check q16_errors to make sure it can
+   // get the information it needs.
+   if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) != 0x00 ) return;
+   q16_stale &= ~pages;
+
+   if (pages & CMST::Page_Status) this->assembleTabStatus();
+   if (pages & CMST::Page_Details) this->assembleTabDetails();
+   if (pages & CMST::Page_Wireless) this->assembleTabWireless();
+   if (pages & CMST::Page_VPN) this->assembleTabVPN();
+   if (pages & CMST::Page_Counters) this->assembleTabCounters();
+   if (pages & CMST::Page_Preferences) this->assembleTabPreferences();
+
+   if (pages & CMST::Page_Status) {
       ui.pushButton_movebefore->setEnabled(false);
       ui.pushButton_moveafter->setEnabled(false);
-
-   } // if there were no major errors
+   }
 
    return;
 }
+
+//
+// Function to return the page flag of the tab the user can see, or
+// Page_None if the dialog is hidden.
+quint16 ControlBox::visiblePage()
+{
+   if (! this->isVisible() ) return CMST::Page_None;
+
+   const QWidget* w = ui.tabWidget->currentWidget();
+   if (w == ui.Status) return CMST::Page_Status;
+   if (w == ui.Details) return CMST::Page_Details;
+   if (w == ui.Wireless) return CMST::Page_Wireless;
+   if (w == ui.VPN) return CMST::Page_VPN;
+   if (w == ui.Counters) return CMST::Page_Counters;
+   if (w == ui.Preferences) return CMST::Page_Preferences;
+
+   return CMST::Page_None;
+}
 //
 // Slot to move the selected service before or after another service.
 // Called when an item in mvsrv_menu is selected.  QAction act is the
@@ -676,11 +795,11 @@ void ControlBox::moveService(QAction* act)
    // See if act belongs to a service
    QString ss;
    QDBusObjectPath targetobj;
-   for (int i = 0; i < services_list.size(); ++i) {
-      ss = getNickName(services_list.at(i).objpath);
-      // the items in mvsrv_menu are in the same order as services_list
+   for (int i = 0; i < store.services().size(); ++i) {
+      ss = store.nickName(store.services().at(i).objpath);
+      // the items in mvsrv_menu are in the same order as the services list
       if (ss == act->text() ) {
-         targetobj = QDBusObjectPath(services_list.at(i).objpath.path());
+         targetobj = QDBusObjectPath(store.services().at(i).objpath.path());
          break;
       } // if
    } // for
@@ -688,28 +807,22 @@ void ControlBox::moveService(QAction* act)
    // make sure we got a targetobject, if not most likely cancel pressed
    if (targetobj.path().isEmpty()) return;
 
-   // get enough information from tableWidget_services to identify the source object
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = ui.tableWidget_services->selectedItems();
-   if (list.isEmpty() ) return;
+   // get the object path of the service selected in tableView_services
+   const QString sourcepath = selectedPath(ui.tableView_services);
+   if (sourcepath.isEmpty() ) return;
 
    // set user initiated flag (for vpn kill switch)
    b_userinitiated = true;
 
    // apply the movebefore or moveafter message to the source object
-   QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, services_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-   if (iface_serv->isValid() ) {
-      if (mvsrv_menu->title() == ui.actionMove_Before->text()) {
-         shared::processReply(iface_serv->call(QDBus::AutoDetect, "MoveBefore", QVariant::fromValue(targetobj)) );
-      }
-      else {
-         shared::processReply(iface_serv->call(QDBus::AutoDetect, "MoveAfter", QVariant::fromValue(targetobj)) );
-      } // else
-   } // iface_srv is valid
+   NetConnmanServiceInterface* iface_serv = proxies->service(sourcepath);
+   if (mvsrv_menu->title() == ui.actionMove_Before->text()) {
+      shared::processReply(iface_serv->MoveBefore(targetobj) );
+   }
+   else {
+      shared::processReply(iface_serv->MoveAfter(targetobj) );
+   } // else
 
-   // clean up
-   iface_serv->deleteLater();
    return;
 }
 
@@ -725,26 +838,25 @@ void ControlBox::moveButtonPressed(QAction* act)
 
 //
 // Slot to enable the movebefore and moveafter buttons, and to prepare the poupup menu
-// Called when a cell is clicked in ui.tableWidget_services
-void ControlBox::enableMoveButtons(int row, int col)
+// Called when a cell is clicked in ui.tableView_services
+void ControlBox::enableMoveButtons(const QModelIndex& idx)
 {
-   (void)col;
-
    // variables
+   const int row = store.services().indexOf(idx.data(StoreModel::PathRole).toString() );
    bool b_validsource = false;
    bool b_validtarget = false;
 
    // create the menu to show if a user selects one of the buttons
    mvsrv_menu->clear();
-   for (int i = 0; i < services_list.size(); ++i) {
-      QAction* act = mvsrv_menu->addAction(getNickName(services_list.at(i).objpath) );
+   for (int i = 0; i < store.services().size(); ++i) {
+      QAction* act = mvsrv_menu->addAction(store.nickName(store.services().at(i).objpath) );
 
       // inspect the service, can only move if service is favorite, ready or online
       // vpn services can be moved (I was wrong thinking they could not), see https://01.org/jira/browse/CM-620
       // 2021.05.08 - on further consideration moving vpn services is not a good idea, disable the ability to do so
-      if (services_list.at(i).objmap.value("Favorite").toBool() &&
-         (services_list.at(i).objmap.value("Type").toString() != "vpn") &&
-         (services_list.at(i).objmap.value("State").toString() == "online" || services_list.at(i).objmap.value("State").toString() == "ready") ) {
+      if (store.services().at(i).favorite &&
+         (store.services().at(i).type != ServiceRecord::Type_VPN) &&
+         (store.services().at(i).state == ServiceRecord::State_Online || store.services().at(i).state == ServiceRecord::State_Ready) ) {
          if (i == row) {
             act->setDisabled(true); // can't move onto itself
             b_validsource = true;
@@ -771,31 +883,201 @@ void ControlBox::enableMoveButtons(int row, int col)
 }
 
 //
-// Slot to update the service label when this->counter is updated.  Other labels in page 4 receive signals directly
-void ControlBox::counterUpdated(const QDBusObjectPath& qdb_objpath, const QString& home_label, const QString& roam_label)
+// Slot called when this->counter is updated.  The data is always recorded,
+// but the labels are only rebuilt if they show the service that changed.
+// If the counters page is not on screen it is just marked stale, otherwise
+// redraws are limited by counter_timer so connman can send updates as often
+// as it likes.
+void ControlBox::counterUpdated(const QDBusObjectPath& qdb_objpath)
 {
-   // Don't update the counter if qdb_objpath is not the online service
-   if (! qdb_objpath.path().contains(onlineobjectpath) ) return;
+   // keep the traffic for the usage history and check the quota with the bytes just used
+   const CounterEntry entry = counter->entries().value(qdb_objpath.path() );
+   quotas->addUsage(qdb_objpath.path(), traffic.addSample(qdb_objpath.path(), entry.home.rx_bytes + entry.roam.rx_bytes, entry.home.tx_bytes + entry.roam.tx_bytes) );
 
-   // Set the labels in page 4
-   if (! qdb_objpath.path().isEmpty() ) {
-      QMap<QString,QVariant> map;
-      for (int i =0; i < services_list.size(); ++i) {
-         if (services_list.at(i).objpath == qdb_objpath) {
-            map = services_list.at(i).objmap;
-            break;
-         } // if
-      } // for
-      ui.label_counter_service_name->setText(tr("<b>Service:</b> %1").arg(getNickName(qdb_objpath)) );
-      ui.label_home_counter->setText(home_label);
-      ui.label_roam_counter->setText(roam_label);
+   const int idx = ui.comboBox_counterservice->currentIndex();
+   if (! (ui.comboBox_counterservice->findData(qdb_objpath.path()) < 0 ||
+         idx == COUNTER_ALL ||
+         (idx == COUNTER_ONLINE && qdb_objpath.path() == onlineobjectpath) ||
+         ui.comboBox_counterservice->currentData().toString() == qdb_objpath.path()) )
+      return;
+
+   if (this->visiblePage() != CMST::Page_Counters) {
+      q16_stale |= CMST::Page_Counters;
+      return;
+   }
+
+   // redraw the first update right away, then at most once per interval
+   if (counter_timer->isActive() )
+      b_counterpending = true;
+   else {
+      scheduleRedraw(CMST::Page_Counters);
+      counter_timer->start();
+   }
+
+   return;
+}
+
+//
+// Slot called when counter_timer times out.  Redraw the counters page if
+// updates arrived while the timer was running.
+void ControlBox::counterRefresh()
+{
+   if (! b_counterpending) return;
+   b_counterpending = false;
+
+   if (this->visiblePage() == CMST::Page_Counters) {
+      scheduleRedraw(CMST::Page_Counters);
+      counter_timer->start();
+   }
+   else
+      q16_stale |= CMST::Page_Counters;
+
+   return;
+}
+
+//
+// Slot to fill the counter labels and the rate graph with the service
+// selected in ui.comboBox_counterservice.  Called when the selection
+// changes and from assembleTabCounters().
+void ControlBox::showCounters()
+{
+   CounterEntry entry;
+   const RateHistory* rh = 0;
+   const int idx = ui.comboBox_counterservice->currentIndex();
+   const int tier = qMax(ui.comboBox_ratetier->currentIndex(), 0);
+   const QString path = idx == COUNTER_ONLINE ? onlineobjectpath : ui.comboBox_counterservice->currentData().toString();
+
+   // usage comes from the saved history, it may be there without counters this session
+   this->assembleUsage(path, idx == COUNTER_ALL);
+   this->assembleQuota(idx == COUNTER_ALL ? QString() : path);
+
+   if (idx == COUNTER_ALL && ! counter->entries().isEmpty() ) {
+      entry = counter->total();
+      rh = counter->totalRates();
+   }
+   else if (! path.isEmpty() && counter->entries().contains(path) ) {
+      entry = counter->entries().value(path);
+      rh = counter->rates(path);
    }
+
+   if (rh == 0) {
+      ui.label_home_counter->setText(tr("Counter not available.") );
+      ui.label_roam_counter->setText(tr("Counter not available.") );
+      ui.label_rate_counter->setText(tr("Rate not available.") );
+      rategraph->setHistory(0, tier);
+      return;
+   } // if no counters
+
+   ui.label_home_counter->setText(counter->getLabel(entry.home) );
+   ui.label_roam_counter->setText(counter->getLabel(entry.roam) );
+
+   // the graph only draws the points added since the last call
+   rategraph->setHistory(rh, tier);
+   const RingBuffer<RatePoint>& rb = rh->tier(tier);
+   if (rb.isEmpty() )
+      ui.label_rate_counter->setText(tr("Rate not available.") );
    else
-      ui.label_counter_service_name->setText(tr("<b>Service:</b> %1").arg(tr("Unable to determine service")) );
+      ui.label_rate_counter->setText(tr("RX: %1  TX: %2  Scale: %3")
+         .arg(RateGraph::rateText(rb.last().rx))
+         .arg(RateGraph::rateText(rb.last().tx))
+         .arg(RateGraph::rateText(rategraph->scale())) );
+
+   return;
+}
+
+//
+// Function to fill the usage label from the traffic history.  path is the
+// service to show, b_all adds all services together.  Periods without
+// traffic are left out.
+void ControlBox::assembleUsage(const QString& path, bool b_all)
+{
+   if (path.isEmpty() && ! b_all) {
+      ui.label_usage_counter->setText(tr("Usage not available.") );
+      return;
+   }
+
+   const bool b_month = ui.comboBox_usageperiod->currentIndex() == 1;
+   const QList<TrafficUsage> usage = traffic.usage(b_all ? QString() : path,
+      b_month ? TrafficHistory::Period_Month : TrafficHistory::Period_Day, b_month ? 12 : 31);
+
+   // newest first, with a total at the bottom
+   QString rows;
+   quint64 rx = 0;
+   quint64 tx = 0;
+   for (int i = usage.size() - 1; i >= 0; --i) {
+      const TrafficUsage& tu = usage.at(i);
+      if (tu.rx == 0 && tu.tx == 0) continue;
+      const QDate d = QDateTime::fromMSecsSinceEpoch(tu.start * 1000).date();
+      rows.append(QString("<tr><td>%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td><td align=\"right\">%4</td></tr>")
+         .arg(b_month ? QLocale().standaloneMonthName(d.month()) + d.toString(" yyyy") : QLocale().toString(d, QLocale::ShortFormat))
+         .arg(ConnmanCounter::bytesText(tu.rx))
+         .arg(ConnmanCounter::bytesText(tu.tx))
+         .arg(ConnmanCounter::bytesText(tu.rx + tu.tx)) );
+      rx += tu.rx;
+      tx += tu.tx;
+   } // for
+
+   if (rows.isEmpty() ) {
+      ui.label_usage_counter->setText(tr("No usage recorded.") );
+      return;
+   }
+
+   ui.label_usage_counter->setText(QString("<table cellspacing=\"6\"><tr><th align=\"left\">%1</th><th align=\"right\">%2</th><th align=\"right\">%3</th><th align=\"right\">%4</th></tr>%5"
+      "<tr><td><b>%6</b></td><td align=\"right\"><b>%7</b></td><td align=\"right\"><b>%8</b></td><td align=\"right\"><b>%9</b></td></tr></table>")
+      .arg(b_month ? tr("Month") : tr("Day"))
+      .arg(tr("Received"))
+      .arg(tr("Transmitted"))
+      .arg(tr("Total"))
+      .arg(rows)
+      .arg(tr("Total"))
+      .arg(ConnmanCounter::bytesText(rx))
+      .arg(ConnmanCounter::bytesText(tx))
+      .arg(ConnmanCounter::bytesText(rx + tx)) );
 
    return;
 }
 
+//
+// Function to fill the quota widgets with the quota of a service.  An
+// empty path (no online service, or all services) disables them.
+void ControlBox::assembleQuota(const QString& path)
+{
+   ui.groupBox_quota_counter->setEnabled(! path.isEmpty() );
+   if (path.isEmpty() ) {
+      ui.label_quota_status->setText(tr("Select a service to set a quota.") );
+      return;
+   }
+
+   // only load the editing widgets when the service changes, not on every counter update
+   if (quotapath != path) {
+      const Quota quota = quotas->quota(path);
+      QStringList sl;
+      for (int i = 0; i < quota.thresholds.size(); ++i) {
+         sl << QString::number(quota.thresholds.at(i) );
+      } // for
+      ui.spinBox_quotamb->setValue(static_cast<int>(quota.limit / (1024 * 1024)) );
+      ui.comboBox_quotaperiod->setCurrentIndex(quota.period);
+      ui.spinBox_quotaresetday->setValue(quota.resetday);
+      if (quotas->hasQuota(path) ) ui.lineEdit_quotathresholds->setText(sl.join(", ") );
+      ui.comboBox_quotaaction->setCurrentIndex(quota.action);
+      quotapath = path;
+   } // if
+
+   if (! quotas->hasQuota(path) ) {
+      ui.label_quota_status->setText(tr("No quota.") );
+      return;
+   }
+
+   const Quota quota = quotas->quota(path);
+   const quint64 used = quotas->used(path);
+   ui.label_quota_status->setText(tr("Used %1 of %2 (%3%) since %4")
+      .arg(ConnmanCounter::bytesText(used))
+      .arg(ConnmanCounter::bytesText(quota.limit))
+      .arg(static_cast<int>(used * 100 / quota.limit))
+      .arg(QLocale().toString(QDateTime::fromMSecsSinceEpoch(quotas->periodStart(path) * 1000).date(), QLocale::ShortFormat)) );
+
+   return;
+}
 
 //
 // Slot to connect a wifi or vpn service. Called when ui.pushButton_connect
@@ -807,22 +1089,14 @@ void ControlBox::counterUpdated(const QDBusObjectPath& qdb_objpath, const QStrin
 void ControlBox::connectPressed()
 {
    // Process wifi or vpn depending on who sent the signal
-   QTableWidget* qtw = NULL;
-   if (sender() == ui.pushButton_connect) qtw = ui.tableWidget_wifi;
-      else if (sender() == ui.pushButton_vpn_connect)  qtw = ui.tableWidget_vpn;
+   QTableView* qtv = NULL;
+   if (sender() == ui.pushButton_connect) qtv = ui.tableView_wifi;
+      else if (sender() == ui.pushButton_vpn_connect)  qtv = ui.tableView_vpn;
          else return;
 
-   // If there is only one row select it
-   if (qtw->rowCount() == 1 ) {
-      QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(0, 0, 0, qtw->columnCount() - 1);
-      qtw->setRangeSelected(qtwsr, true);
-   }
-
    // If no row is selected then return
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = qtw->selectedItems();
-   if (list.isEmpty() ) {
+   const QString path = selectedPath(qtv);
+   if (path.isEmpty() ) {
       QMessageBox::information(this, tr("No Services Selected"),
          tr("You need to select a service before pressing the connect button.") );
       return;
@@ -830,15 +1104,11 @@ void ControlBox::connectPressed()
 
    // set the manual flag (for vpn kill switch)
    b_userinitiated = true;
-
-   //Because of single selection mode list can only have 0 or 1 items in it.
-   if (qtw == ui.tableWidget_wifi) pendingobjectpath = wifi_list.at(list.at(0)->row()).objpath.path();
-      else if (qtw == ui.tableWidget_vpn) pendingobjectpath = vpn_list.at(list.at(0)->row()).objpath.path();
-         else pendingobjectpath.clear();
+   pendingobjectpath = path;
 
    // execute external program if specified
    if (! ui.lineEdit_beforeconnect->text().isEmpty() ) {
-      if (list.at(0)->text() == ui.comboBox_beforeconnectserviceslist->currentText() ) {
+      if (store.nickName(QDBusObjectPath(path)) == ui.comboBox_beforeconnectserviceslist->currentText() ) {
          QString text = ui.lineEdit_beforeconnect->text();
          text = text.simplified();
          QStringList args = text.split(' ');
@@ -871,15 +1141,34 @@ void ControlBox::requestConnection()
    if (proc)  delete proc;
    if (gened) delete gened;
 
-   // data member
-   QDBusInterface* iface_serv = NULL;
+   // Connect does not return until the agent has been answered, so don't wait for it
+   watchConnect(proxies->service(pendingobjectpath)->Connect() );
+
+   return;
+}
+
+//
+// Function to watch a Connect (or vpn Disconnect) call.  These calls don't
+// return until connman is finished talking to our agent, so we never wait
+// for them.  The reply is checked in connectReplied().
+void ControlBox::watchConnect(const QDBusPendingCall& call)
+{
+   QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(call, this);
+   connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(connectReplied(QDBusPendingCallWatcher*)));
+
+   return;
+}
+
+//
+// Slot called when the reply to a call sent by watchConnect() arrives.  A
+// timeout just means the user took a long time with the agent dialog.
+void ControlBox::connectReplied(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusMessage reply = watcher->reply();
+   watcher->deleteLater();
 
-   iface_serv = new QDBusInterface(DBUS_CON_SERVICE, pendingobjectpath, "net.connman.Service", QDBusConnection::systemBus(), this);
-   iface_serv->setTimeout(5); // need a short timeout to get the Agent
-   QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Connect");
    if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply") shared::processReply(reply);
 
-   iface_serv->deleteLater();
    return;
 }
 
@@ -889,31 +1178,29 @@ void ControlBox::requestConnection()
 void ControlBox::disconnectPressed()
 {
    // Process wifi or vpn depending on who sent the signal
-   QTableWidget* qtw = NULL;
-   if (sender() == ui.pushButton_disconnect) qtw = ui.tableWidget_wifi;
-      else if (sender() == ui.pushButton_vpn_disconnect) qtw = ui.tableWidget_vpn;
+   QTableView* qtv = NULL;
+   if (sender() == ui.pushButton_disconnect) qtv = ui.tableView_wifi;
+      else if (sender() == ui.pushButton_vpn_disconnect) qtv = ui.tableView_vpn;
          else  return;
+   StoreModel* model = static_cast<StoreModel*>(qtv->model() );
 
    // If there is no item is selected run through the list looking for
    // services in "online" or "ready" state. If more than one is found
    // break as we will have to use the one currently selected.
    int cntr_connected = 0;
    int row_connected = -1;
-   if (qtw->selectedItems().isEmpty() ) {
+   if (! qtv->selectionModel()->hasSelection() ) {
       int itemcount = 0;
-      QMap<QString,QVariant> map;
-      if (qtw == ui.tableWidget_wifi) itemcount = wifi_list.size();
-      else if (qtw == ui.tableWidget_vpn)  itemcount = vpn_list.size();
+      if (qtv == ui.tableView_wifi) itemcount = store.wifiCount();
+      else if (qtv == ui.tableView_vpn)  itemcount = store.vpnCount();
       else return; // line is not really needed
 
       for (int row = 0; row < itemcount; ++row) {
-         if (qtw == ui.tableWidget_wifi) map = wifi_list.at(row).objmap;
-         else if (qtw == ui.tableWidget_vpn)  map = vpn_list.at(row).objmap;
-         else return; // line is not really needed
+         const ServiceRecord& rec = (qtv == ui.tableView_wifi) ? store.wifiAt(row) : store.vpnAt(row);
 
-         if (map.value("State").toString() == "online" || map.value("State").toString() == "ready" ) {
+         if (rec.isConnected() ) {
             ++cntr_connected;
-            row_connected = row;
+            row_connected = model->rowOf(rec.objpath.path() );
          }
          if (cntr_connected > 1 ) break;
       } // for
@@ -922,17 +1209,12 @@ void ControlBox::disconnectPressed()
       if (cntr_connected == 0) return;
 
       // If only one entry is connected or online, select it
-      if (cntr_connected == 1 ) {
-         QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(row_connected, 0, row_connected, qtw->columnCount() - 1);
-         qtw->setRangeSelected(qtwsr, true);
-      } // cntr_connected == 1
+      if (cntr_connected == 1 && row_connected >= 0) qtv->selectRow(row_connected);
    } // if there are no currently selected items
 
    // If no row selected return
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = qtw->selectedItems();
-   if (list.isEmpty() ) {
+   const QString path = selectedPath(qtv);
+   if (path.isEmpty() ) {
       QMessageBox::information(this, tr("No Services Selected"),
          tr("You need to select a service before pressing the disconnect button.") );
       return;
@@ -941,16 +1223,9 @@ void ControlBox::disconnectPressed()
    // set user initiated flag (for vpn kill switch)
    b_userinitiated = true;
 
-   // Send the disconnect message to the service.  TableWidget only allows single selection so list can only have 0 or 1 elments
-   QDBusInterface* iface_serv = NULL;
-   if (qtw == ui.tableWidget_wifi)
-      iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-   else if (qtw == ui.tableWidget_vpn)
-      iface_serv = new QDBusInterface(DBUS_CON_SERVICE, vpn_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-   else return; // this line really not needed
+   // Send the disconnect message to the service
+   shared::processReply(proxies->service(path)->Disconnect() );
 
-   shared::processReply(iface_serv->call(QDBus::AutoDetect, "Disconnect") );
-   iface_serv->deleteLater();
    return;
 }
 
@@ -959,31 +1234,20 @@ void ControlBox::disconnectPressed()
 // Called when ui.pushButton_remove is pressed
 void ControlBox::removePressed()
 {
-   // If there is only one row select it
-   if (ui.tableWidget_wifi->rowCount() == 1 ) {
-      QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(0, 0, 0, ui.tableWidget_wifi->columnCount() - 1);
-      ui.tableWidget_wifi->setRangeSelected(qtwsr, true);
-   }
-
    // If no row is selected then return
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = ui.tableWidget_wifi->selectedItems();
-   if (list.isEmpty() ) {
+   const QString path = selectedPath(ui.tableView_wifi);
+   if (path.isEmpty() ) {
       QMessageBox::information(this, tr("No Services Selected"),
          tr("You need to select a Wifi service before pressing the remove button.") );
       return;
    }
 
    // calling Remove() on hidden or provisioned services will cause an error, so simply return now without executing the method.
-   QMap<QString,QVariant> map = wifi_list.at(list.at(0)->row()).objmap;
-   if(map.value("Name").toString().isEmpty() || map.value("Immutable").toBool() ) return;
+   const ServiceRecord* rec = store.services().find(path);
+   if (rec == NULL || rec->name.isEmpty() || rec->immutable ) return;
 
    // send the Remove message to the service
-   QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(list.at(0)->row()).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-   QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Remove");
-   shared::processReply(reply);
-   iface_serv->deleteLater();
+   shared::processReply(proxies->service(path)->Remove() );
 
    return;
 }
@@ -993,17 +1257,9 @@ void ControlBox::removePressed()
 // anything about the permissions the CMST user has.  The best we can do issue a remove call then a connect call.
 void ControlBox::editPressed()
 {
-   // If there is only one row select it
-   if (ui.tableWidget_wifi->rowCount() == 1 ) {
-      QTableWidgetSelectionRange qtwsr = QTableWidgetSelectionRange(0, 0, 0, ui.tableWidget_wifi->columnCount() - 1);
-      ui.tableWidget_wifi->setRangeSelected(qtwsr, true);
-   }
-
    // if no row selected return
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = ui.tableWidget_wifi->selectedItems();
-   if (list.isEmpty() ) {
+   const QString path = selectedPath(ui.tableView_wifi);
+   if (path.isEmpty() ) {
       QMessageBox::information(this, tr("No Services Selected"),
          tr("You need to select a Wifi service before pressing the edit button.") );
       return;
@@ -1013,7 +1269,7 @@ void ControlBox::editPressed()
    this->removePressed();
 
    // connect the connection which will ask for user information if needed
-   pendingobjectpath = wifi_list.at(list.at(0)->row()).objpath.path();
+   pendingobjectpath = path;
    this->requestConnection();
 
    return;
@@ -1097,8 +1353,8 @@ void ControlBox::removeVPN()
 void ControlBox::dbsPropertyChanged(QString prop, QDBusVariant dbvalue)
 {
    // save current state and update propertiesMap
-   QString oldstate = properties_map.value(prop).toString();
-   properties_map.insert(prop, dbvalue.variant() );
+   QString oldstate = store.properties().value(prop).toString();
+   store.setProperty(prop, dbvalue.variant() );
 
    // updateDisplayWidgets() removed for issue #240 - displaywidgets should update when services list changes which must happen when properties change.
    // refresh display widgets
@@ -1167,86 +1423,30 @@ void ControlBox::dbsPropertyChanged(QString prop, QDBusVariant dbvalue)
 // of a service object changes.
 void ControlBox::dbsServicesChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
 {
-   // save the current service at the top of the list, used for vpn internet kill switch
-   QMap<QString,QVariant> topmap;
-   if (services_list.size() > 0) topmap = services_list.at(0).objmap;
-
    // process removed services
-   if (! removed.isEmpty() ) {
-      for (int i = 0; i < services_list.count(); ++i) {
-         if (removed.contains(services_list.at(i).objpath) ) {
-            QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, services_list.at(i).objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-            services_list.removeAt(i);
-         } // if
-      } // for
-   } // if we needed to remove something
+   ChangeSet changes;
+   if (! removed.isEmpty() ) store.removeServices(removed, changes);
 
    // process added or changed servcies
-   // Demarshall the raw QDBusMessage instead of vlist as it is easier..
-   if (! vlist.isEmpty() ) {
-      QList<arrayElement> revised_list;
-      if (! getArray(revised_list, msg)) return;
+   // Demarshall the raw QDBusMessage instead of vlist, the store decodes
+   // the array straight into the service records.
+   if (! vlist.isEmpty() && msg.arguments().at(0).canConvert<QDBusArgument>() )
+      store.mergeServices(msg.arguments().at(0).value<QDBusArgument>(), changes);
 
-      // merge the existing services_list into the revised_list
-      // first find the original element that matches the revised
-      for (int i = 0; i < revised_list.size(); ++i) {
-         arrayElement revised_element = revised_list.at(i);
-         arrayElement original_element = {QDBusObjectPath(), QMap<QString,QVariant>()};
-         for (int j = 0; j < services_list.size(); ++j) {
-            if (revised_element.objpath == services_list.at(j).objpath) {
-               original_element = services_list.at(j);
-               break;
-            } // if
-         } // j for
-
-         // merge the new elementArray into the existing
-         if (! original_element.objpath.path().isEmpty()) {
-            QMapIterator<QString, QVariant> itr(revised_element.objmap);
-            while (itr.hasNext()) {
-               itr.next();
-               original_element.objmap.insert(itr.key(), itr.value() );
-            } // while
-
-            // now insert the element into the revised list
-            QDBusConnection::systemBus().disconnect(DBUS_CON_SERVICE, original_element.objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-            revised_list.replace(i, original_element);
-            QDBusConnection::systemBus().connect(DBUS_CON_SERVICE, revised_element.objpath.path(), "net.connman.Service", "PropertyChanged", this, SLOT(dbsServicePropertyChanged(QString, QDBusVariant, QDBusMessage)));
-         } // if original element is not empty
-      } // i for
-
-      // now copy the revised list to services_list
-      services_list.clear();
-      services_list = revised_list;
-   } // revised_list not empty
+   // the vpn internet kill switch goes first, before anything slow
+   killswitch->servicesChanged(b_userinitiated);
+   b_userinitiated = false;
+   noteServiceChanges(changes);
+
+   // drop what we keep about services that are gone
+   evictServices(changes);
+   quotas->servicesAdded(changes.inserted);
 
    // clear the counters (if selected) and update the widgets
    clearCounters();
 
-   // see if we need to engage the vpn internet kill switch
-   // could probably animateClick the airplane mode checkbox or just call airplane mode via dBus, but I would prefer to look at each technology
-   // and power each one down.
-   if (ui.checkBox_killswitch->isChecked() && ! b_userinitiated) {
-      if (topmap.value("Type").toString() == "vpn" ) {
-         QMap<QString,QVariant> curtopmap;
-         if (services_list.size() > 0) curtopmap = services_list.at(0).objmap;
-         if (curtopmap.value("Type").toString() != "vpn") {
-         for (int i = 0; i < technologies_list.size(); ++i) {
-            if (technologies_list.at(i).objmap.value("Powered").toBool()) {
-            QDBusInterface iface_tech(DBUS_CON_SERVICE, technologies_list.at(i).objpath.path(), "net.connman.Technology", QDBusConnection::systemBus(), this);
-            shared::processReply(iface_tech.call(QDBus::AutoDetect, "SetProperty", "Powered", QVariant::fromValue(QDBusVariant(false))) );
-            } // if technology is currently powered
-         } // for each technology
-         notifyclient->init();
-         notifyclient->setSummary(tr("VPN Kill Switch Engaged"));
-         notifyclient->setBody(tr("The connection to VPN service %1 was dropped and the VPN kill switch was engaged. All network devices are powered off.").arg(topmap.value("Name").toString()));
-         this->sendNotifications();
-         } // if curtopmap type = vpn
-      } // if topmap type == vpn
-   } // if kill swich
-   b_userinitiated = false;
-
-   // update the widgets
-   updateDisplayWidgets();
+   // update the widgets, the models only look at the rows in changes
+   if (! changes.isEmpty() ) scheduleRedraw(CMST::Page_Services);
 
    return;
 }
@@ -1256,60 +1456,20 @@ void ControlBox::dbsServicesChanged(QList<QVariant> vlist, QList<QDBusObjectPath
 // scan results being signaled here.
 void ControlBox::dbsPeersChanged(QList<QVariant> vlist, QList<QDBusObjectPath> removed, QDBusMessage msg)
 {
-   // Set the update flag
-   bool b_needupdate = false;
-
    // Process changed peers. Demarshal the raw QDBusMessage instead of vlist as it is easier.
+   ChangeSet changes;
    if (! vlist.isEmpty() ) {
       QList<arrayElement> revised_list;
       if (! getArray(revised_list, msg)) return;
 
-      // if revised_list is not the same size as the existing peer_list
-      // then we definetely need an update
-      if (revised_list.count() != peer_list.count() ) b_needupdate = true;
-
-      // merge the existing peers_list into the revised_list
-      // first find the original element that matches the revised
-      for (int i = 0; i < revised_list.size(); ++i) {
-         arrayElement revised_element = revised_list.at(i);
-         arrayElement original_element = {QDBusObjectPath(), QMap<QString,QVariant>()};
-         for (int j = 0; j < peer_list.size(); ++j) {
-            if (revised_element.objpath == peer_list.at(j).objpath) {
-               original_element = peer_list.at(j);
-               break;
-            } // if
-         } // j for
-
-         // merge the new elementArray into the existing
-         if (! original_element.objpath.path().isEmpty()) {
-            QMapIterator<QString, QVariant> itr(revised_element.objmap);
-            while (itr.hasNext()) {
-               itr.next();
-               b_needupdate = true;
-               original_element.objmap.insert(itr.key(), itr.value() );
-               } // while
-
-            // now insert the element into the revised list
-            revised_list.replace(i, original_element);
-         } // if original element exists
-      } // i for
-
-      // now copy the revised list to peer_list
-      peer_list.clear();
-      peer_list = revised_list;
+      // merge the revised list into the store
+      store.mergePeers(revised_list, changes);
    } // vlist not empty
 
    // process removed peers
-   if (! removed.isEmpty() ) {
-      for (int i = 0; i < peer_list.count(); ++i) {
-         if (removed.contains(peer_list.at(i).objpath) )
-            peer_list.removeAt(i);
-      } // for
-   } // if we needed to remove something
-
-   // update the widgets
-   if (b_needupdate) updateDisplayWidgets();
+   if (! removed.isEmpty() ) store.removePeers(removed, changes);
 
+   // peers are not shown on any of our pages so there is nothing to redraw
    return;
 }
 
@@ -1329,25 +1489,12 @@ void ControlBox::dbsTechnologyAdded(QDBusObjectPath path, QVariantMap properties
       properties.insert(itr.key(), itr.value() );
    } // map iterator
 
-   // construct an arrayElement
+   // construct an arrayElement, if the element exists the store replaces it
+   // otherwise it is added to the end of the list
    arrayElement ae = {path, properties};
-   bool newelem = true;
-
-   // first see if the element exists, if so replace it
-   for (int i = 0; i < technologies_list.count(); ++i) {
-      if (path == technologies_list.at(i).objpath) {
-         technologies_list.replace(i, ae);
-         newelem = false;
-         break;
-      } // if
-   } // for
-
-   // if it is a new element add it
-   if (newelem) {
-      technologies_list.append(ae);
-   }
+   store.addTechnology(ae);
 
-   updateDisplayWidgets();
+   scheduleRedraw(CMST::Page_Status | CMST::Page_Wireless | CMST::Page_TrayIcon);
 
    return;
 }
@@ -1356,14 +1503,10 @@ void ControlBox::dbsTechnologyAdded(QDBusObjectPath path, QVariantMap properties
 // Slot called whenever DBUS issues a TechonlogyRemoved signal
 void ControlBox::dbsTechnologyRemoved(QDBusObjectPath removed)
 {
-   for (int i = 0; i < technologies_list.count(); ++i) {
-      if ( removed == technologies_list.at(i).objpath ) {
-         technologies_list.removeAt(i);
-         break;
-      } // if
-   } // for
+   store.removeTechnology(removed);
+   proxies->evict(removed.path() );
 
-   updateDisplayWidgets();
+   scheduleRedraw(CMST::Page_Status | CMST::Page_Wireless | CMST::Page_TrayIcon);
 
    return;
 }
@@ -1371,28 +1514,30 @@ void ControlBox::dbsTechnologyRemoved(QDBusObjectPath removed)
 //
 // Slots called from objects. The previous slots were called from Manager
 //
-// Slot called whenever a service object issues a PropertyChanged signal on DBUS
+// Slot called whenever a service object issues a PropertyChanged signal on DBUS.
+// This is connected once for all services, ignore any we don't have in the store.
 void ControlBox::dbsServicePropertyChanged(QString property, QDBusVariant dbvalue, QDBusMessage msg)
 {
    QString s_path = msg.path();
    QVariant value = dbvalue.variant();
-   QString s_state;
-
-   // replace the old values with the changed ones.
-   for (int i = 0; i < services_list.count(); ++i) {
-      if (s_path == services_list.at(i).objpath.path() ) {
-         QMap<QString,QVariant> map = services_list.at(i).objmap;
-         map.remove(property);
-         map.insert(property, value );
-         arrayElement ae = {services_list.at(i).objpath, map};
-         services_list.replace(i, ae);
-         s_state = map.value("State").toString();
-         break;
-      } // if
-   } // for
+
+   // decide if the change is worth a redraw before the old value is replaced
+   const ServiceRecord* rec = store.services().find(s_path);
+   if (rec == NULL) return;
+   const bool b_redraw = policy.serviceChange(*rec, property, value);
+
+   // replace the old value with the changed one.
+   if (! store.setServiceProperty(s_path, property, value) ) return;
+   ChangeSet changes;
+   changes.changed.append(s_path);
+   noteServiceChanges(changes);
+   const ServiceRecord::State state = store.services().find(s_path)->state;
+
+   // the vpn internet kill switch goes first, before anything slow
+   if (property == "State") killswitch->serviceStateChanged(s_path, state, b_userinitiated);
 
    // process errrors   - errors only valid when service is in the failure state
-   if (property =="Error" && s_state == "failure") {
+   if (property =="Error" && state == ServiceRecord::State_Failure) {
       notifyclient->init();
       notifyclient->setSummary(QString(tr("Service Error: %1")).arg(value.toString()) );
       notifyclient->setBody(QString(tr("Object Path: %1")).arg(s_path) );
@@ -1401,57 +1546,61 @@ void ControlBox::dbsServicePropertyChanged(QString property, QDBusVariant dbvalu
       this->sendNotifications();
    }
 
-   // if state property changed sync the online data members.
+   // if state property changed sync the online data members and let the
+   // reconnect scheduler know.
    if (property == "State") {
+      const ServiceRecord* srec = store.services().find(s_path);
+      reconnector->stateChanged(s_path, state, srec->type == ServiceRecord::Type_Wifi && srec->favorite);
       if (value.toString() == "online") {
          onlineobjectpath = s_path;
       } //
       else if (s_path == onlineobjectpath) {
          onlineobjectpath.clear();
       } // else if object went offline
+      if (ui.comboBox_counterservice->currentIndex() == COUNTER_ONLINE) scheduleRedraw(CMST::Page_Counters);
    } // if property contains State
 
-   // update the widgets
-   updateDisplayWidgets();
+   // update the widgets.  The store always has the new value, small
+   // strength changes just don't cause a redraw of their own.
+   if (b_redraw) scheduleRedraw(CMST::Page_Services);
 
    return;
 }
 
 //
-// Slot called whenever a vpn connection issues a PropertyChanged signal on DBUS
+// Slot called whenever a vpn connection issues a PropertyChanged signal on DBUS.
+// Connected once for all vpn connections, only the ones from GetConnections are used.
 void ControlBox::dbsVPNPropertyChanged(QString property, QDBusVariant dbvalue, QDBusMessage msg)
 {
    QString s_path = msg.path();
    QVariant value = dbvalue.variant();
+   if (! store.vpnConnections().contains(s_path) ) return;
 
    if (property == "State") {
       // This is sort of a hack.  Not all VPN service properties are signaled when they change (for instance Provider, IPV4).  This slot was created to address that, plus we moved the notification code from dbsServicePropertyChanged to here. Force a new service list to be created.
       getServices();
 
       // Send notification if vpn changed
-      for (int i = 0; i < vpnconn_list.count(); ++i) {
-         if (s_path == vpnconn_list.at(i).objpath.path() ) {
-            notifyclient->init();
-            if (value.toString() == "ready") {
-               notifyclient->setSummary(QString(tr("VPN Engaged")) );
-               notifyclient->setIcon(iconman->getIconName("connection_vpn") );
-            }
-            else {
-               notifyclient->setSummary(QString(tr("VPN Disengaged")) );
-               notifyclient->setIcon(iconman->getIconName("connection_not_ready") );
-            }
-            notifyclient->setBody(QString(tr("Object Path: %1")).arg(s_path) );
-            notifyclient->setUrgency(Nc::UrgencyNormal);
-            this->sendNotifications();
-            break;
-         } // if
-      } // for
+      if (store.vpnConnections().contains(s_path) ) {
+         notifyclient->init();
+         if (value.toString() == "ready") {
+            notifyclient->setSummary(QString(tr("VPN Engaged")) );
+            notifyclient->setIcon(iconman->getIconName("connection_vpn") );
+         }
+         else {
+            notifyclient->setSummary(QString(tr("VPN Disengaged")) );
+            notifyclient->setIcon(iconman->getIconName("connection_not_ready") );
+         }
+         notifyclient->setBody(QString(tr("Object Path: %1")).arg(s_path) );
+         notifyclient->setUrgency(Nc::UrgencyNormal);
+         this->sendNotifications();
+      } // if
    } // if property = State
 
-// update the widgets
-  updateDisplayWidgets();
+   // update the widgets
+   scheduleRedraw(CMST::Page_Services);
 
-  return;
+   return;
 }
 
 //
@@ -1460,19 +1609,10 @@ void ControlBox::dbsTechnologyPropertyChanged(QString name, QDBusVariant dbvalue
 {
    QString s_path = msg.path();
 
-   // replace the old values with the changed ones.
-   for (int i = 0; i < technologies_list.count(); ++i) {
-      if (s_path == technologies_list.at(i).objpath.path() ) {
-         QMap<QString,QVariant> map = technologies_list.at(i).objmap;
-         map.remove(name);
-         map.insert(name, dbvalue.variant() );
-         arrayElement ae = {technologies_list.at(i).objpath, map};
-         technologies_list.replace(i, ae);
-         break;
-      } // if
-   } // for
+   // replace the old value with the changed one, ignore technologies we don't know
+   if (! store.setTechnologyProperty(s_path, name, dbvalue.variant()) ) return;
 
-   updateDisplayWidgets();
+   scheduleRedraw(CMST::Page_Status | CMST::Page_Wireless | CMST::Page_TrayIcon);
 
    return;
 }
@@ -1482,29 +1622,56 @@ void ControlBox::dbsTechnologyPropertyChanged(QString name, QDBusVariant dbvalue
 // the context menu.
 // Results signaled by manager.ServicesChanged(), except for peer
 // services which will be signaled by manager.PeersChanged()
+//
+// The Scan calls go out to every powered wifi technology at once and we
+// don't wait for them.  The rescan controls stay disabled until the last
+// reply comes back to scanFinished().
 void ControlBox::scanWiFi()
 {
-   // Make sure we got the technologies_list before we try to work with it.
+   // Make sure we got the technologies list before we try to work with it.
    if ( (q16_errors & CMST::Err_Technologies) != 0x00 ) return;
 
+   // A scan is already running
+   if (scans_pending > 0) return;
+
    // Clear any selections in the wifi tab
-   ui.tableWidget_wifi->clearSelection();
-
-   // Run through each technology and do a scan for any wifi
-   for (int row = 0; row < technologies_list.size(); ++row) {
-      if (technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
-         if (technologies_list.at(row).objmap.value("Powered").toBool() ) {
-            setStateRescan(false);
-            ui.tableWidget_services->setCurrentIndex(QModelIndex()); // first cell becomes selected once pushbutton is disabled
-            qApp->processEvents();  // needed to promply disable the button
-            QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, technologies_list.at(row).objpath.path(), "net.connman.Technology", QDBusConnection::systemBus(), this);
+   ui.tableView_wifi->clearSelection();
+
+   // Run through each technology and start a scan on any powered wifi
+   for (int row = 0; row < store.technologies().size(); ++row) {
+      if (store.technologies().at(row).type == ServiceRecord::Type_Wifi) {
+         if (store.technologies().at(row).powered ) {
+            NetConnmanTechnologyInterface* iface_tech = proxies->technology(store.technologies().at(row).objpath.path() );
+            const int tmo = iface_tech->timeout();
             iface_tech->setTimeout( 8 * 1000);  // full 25 second timeout is a bit much when there is a problem
-            QDBusMessage reply = iface_tech->call(QDBus::AutoDetect, "Scan");
-            iface_tech->deleteLater();
+            QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(iface_tech->Scan(), this);
+            iface_tech->setTimeout(tmo);    // the proxy is shared, put the timeout back
+            connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(scanFinished(QDBusPendingCallWatcher*)));
+            ++scans_pending;
          } // if the wifi was powered
       } // if the list item is wifi
    } // for
 
+   if (scans_pending > 0) {
+      setStateRescan(false);
+      ui.tableView_services->setCurrentIndex(QModelIndex()); // first cell becomes selected once pushbutton is disabled
+   } // if
+
+   return;
+}
+
+//
+// Slot called when a Scan call sent by scanWiFi() returns.  As before the
+// reply itself is not checked, the results arrive in ServicesChanged.
+// When the last scan is in enable the rescan controls again.
+void ControlBox::scanFinished(QDBusPendingCallWatcher* watcher)
+{
+   watcher->deleteLater();
+
+   if (--scans_pending > 0) return;
+   scans_pending = 0;
+   setStateRescan(store.wifiCount() > 0);
+
    return;
 }
 
@@ -1513,43 +1680,40 @@ void ControlBox::scanWiFi()
 // toggleTethered().
 void ControlBox::wifiIDPass(const QString& obj_path)
 {
-   // Make sure we got the technologies_list before we try to work with it.
+   // Make sure we got the technologies list before we try to work with it.
    if ( (q16_errors & CMST::Err_Technologies) != 0x00 ) return;
 
    // Run through each technology looking for Wifi
-   for (int row = 0; row < technologies_list.size(); ++row) {
-      if (technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
-         if (technologies_list.at(row).objpath.path() == obj_path || obj_path.isEmpty() ) {
-            QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, technologies_list.at(row).objpath.path(), "net.connman.Technology", QDBusConnection::systemBus(), this);
+   for (int row = 0; row < store.technologies().size(); ++row) {
+      if (store.technologies().at(row).type == ServiceRecord::Type_Wifi) {
+         if (store.technologies().at(row).objpath.path() == obj_path || obj_path.isEmpty() ) {
+            NetConnmanTechnologyInterface* iface_tech = proxies->technology(store.technologies().at(row).objpath.path() );
 
             shared::ValidatingDialog* vd01 = new shared::ValidatingDialog(this);
-            vd01->setLabel(tr("<b>Technology: %1</b><p>Please enter the WiFi AP SSID that clients will<br>have to join in order to gain internet connectivity.").arg(technologies_list.at(row).objpath.path()) ),
+            vd01->setLabel(tr("<b>Technology: %1</b><p>Please enter the WiFi AP SSID that clients will<br>have to join in order to gain internet connectivity.").arg(store.technologies().at(row).objpath.path()) ),
             vd01->setValidator(CMST::ValDialog_min1ch);
-            vd01->setText(technologies_list.at(row).objmap.value("TetheringIdentifier").toString() );
+            vd01->setText(store.technologies().at(row).tetheringidentifier );
             if (vd01->exec() == QDialog::Accepted) {
-               if (vd01->getText() !=  technologies_list.at(row).objmap.value("TetheringIdentifier").toString()) {
-                  shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "TetheringIdentifier", QVariant::fromValue(QDBusVariant(vd01->getText()))) );
+               if (vd01->getText() !=  store.technologies().at(row).tetheringidentifier) {
+                  shared::processReply(iface_tech->SetProperty("TetheringIdentifier", QDBusVariant(vd01->getText())) );
                }
             } // if accepted
             vd01->deleteLater();
 
-            if (! technologies_list.at(row).objmap.value("TetheringIdentifier").toString().isEmpty() ) {
+            if (! store.technologies().at(row).tetheringidentifier.isEmpty() ) {
                shared::ValidatingDialog* vd02 = new shared::ValidatingDialog(this);
-               vd02->setLabel(tr("<b>Technology: %1</b><p>Please enter the WPA pre-shared key clients will<br>have to use in order to establish a connection.<p>PSK length: minimum of 8 characters.").arg(technologies_list.at(row).objpath.path()) );
+               vd02->setLabel(tr("<b>Technology: %1</b><p>Please enter the WPA pre-shared key clients will<br>have to use in order to establish a connection.<p>PSK length: minimum of 8 characters.").arg(store.technologies().at(row).objpath.path()) );
                vd02->setValidator(CMST::ValDialog_min8ch);
-               vd02->setText(technologies_list.at(row).objmap.value("TetheringPassphrase").toString() );
+               vd02->setText(store.technologies().at(row).tetheringpassphrase );
                if (vd02->exec() == QDialog::Accepted)
-                  if (vd02->getText() != technologies_list.at(row).objmap.value("TetheringPassphrase").toString() )
-            shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "TetheringPassphrase", QVariant::fromValue(QDBusVariant(vd02->getText()))) );
+                  if (vd02->getText() != store.technologies().at(row).tetheringpassphrase )
+            shared::processReply(iface_tech->SetProperty("TetheringPassphrase", QDBusVariant(vd02->getText())) );
 
                vd02->deleteLater();
             } // if
-
-            // cleanup
-            iface_tech->deleteLater();
          } // if wifi match
       } // if tech is wifi
-   } // for technologies_list.size()
+   } // for store.technologies().size()
 
    return;
 }
@@ -1561,41 +1725,36 @@ void ControlBox::toggleOfflineMode(bool checked)
 {
    if ( ((q16_errors & CMST::Err_No_DBus) | (q16_errors & CMST::Err_Invalid_Con_Iface)) != 0x00 ) return;
 
-   shared::processReply(con_manager->call(QDBus::AutoDetect, "SetProperty", "OfflineMode", QVariant::fromValue(QDBusVariant(checked ? true : false))) );
+   shared::processReply(con_manager->SetProperty("OfflineMode", QDBusVariant(checked ? true : false)) );
 
    return;
 }
 
 //
 // Slot to toggle the powered state of a technology
-// Called when our custom idButton in the powered cell in the page 1 technology tableWidget is clicked
+// Called when the button in the powered cell in the page 1 technology table is clicked
 void ControlBox::togglePowered(QString object_id, bool checkstate)
 {
-   QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, object_id, "net.connman.Technology", QDBusConnection::systemBus(), this);
-   shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "Powered", QVariant::fromValue(QDBusVariant(checkstate))) );
+   shared::processReply(proxies->technology(object_id)->SetProperty("Powered", QDBusVariant(checkstate)) );
 
    // set user initiated flag (for vpn kill switch)
    b_userinitiated = true;
 
-   // cleanup
-   iface_tech->deleteLater();
    return;
 }
 
 //
 // Slot to toggle the tethering state of a technology
-// Called when our custom idButton in the tethered cell in the page 1 technology tableWidget is clicked
+// Called when the button in the tethered cell in the page 1 technology table is clicked
 void ControlBox::toggleTethered(QString object_id, bool checkstate)
 {
-   QDBusInterface* iface_tech = new QDBusInterface(DBUS_CON_SERVICE, object_id, "net.connman.Technology", QDBusConnection::systemBus(), this);
-
    // See if this is a wifi technology, get the ID and Pass if necessary
    bool ok = true;
-   for (int row = 0; row < technologies_list.size(); ++row) {
-      if (technologies_list.at(row).objpath.path() == object_id) {
-         if(technologies_list.at(row).objmap.value("Type").toString() == "wifi") {
-            QString sid = technologies_list.at(row).objmap.value("TetheringIdentifier").toString();
-            QString spw = technologies_list.at(row).objmap.value("TetheringPassphrase").toString();
+   for (int row = 0; row < store.technologies().size(); ++row) {
+      if (store.technologies().at(row).objpath.path() == object_id) {
+         if(store.technologies().at(row).type == ServiceRecord::Type_Wifi) {
+            QString sid = store.technologies().at(row).tetheringidentifier;
+            QString spw = store.technologies().at(row).tetheringpassphrase;
             if (sid.isEmpty() || spw.isEmpty() ) wifiIDPass(object_id);
          } // if technology is wifi
       } // if object_id
@@ -1603,11 +1762,9 @@ void ControlBox::toggleTethered(QString object_id, bool checkstate)
 
    // Send message if everything is ok
    if (ok) {
-      shared::processReply(iface_tech->call(QDBus::AutoDetect, "SetProperty", "Tethering", QVariant::fromValue(QDBusVariant(checkstate))) );
+      shared::processReply(proxies->technology(object_id)->SetProperty("Tethering", QDBusVariant(checkstate)) );
    }
 
-   // cleanup
-   iface_tech->deleteLater();
    return;
 }
 
@@ -1638,6 +1795,7 @@ void ControlBox::minMaxWindow(QAction* act)
       // information on the service.
       else {
          ui.tabWidget->setCurrentIndex(1);
+         this->assembleStalePages(CMST::Page_Details);
          ui.comboBox_service->setCurrentIndex(ui.comboBox_service->findText(act->text()) );
          this->showNormal();
       } // inner else
@@ -1653,9 +1811,9 @@ void ControlBox::minMaxWindow(QAction* act)
 void ControlBox::techSubmenuTriggered(QAction* act)
 {
    // find the techology associated with the action and toggle its powered state
-   for (int i = 0; i < technologies_list.count(); ++i) {
-      if (technologies_list.at(i).objmap.value("Name").toString() == act->text() ) {
-         togglePowered(technologies_list.at(i).objpath.path(), act->isChecked() );
+   for (int i = 0; i < store.technologies().count(); ++i) {
+      if (store.technologies().at(i).name == act->text() ) {
+         togglePowered(store.technologies().at(i).objpath.path(), act->isChecked() );
          break;
       } // if
    } // for
@@ -1671,6 +1829,7 @@ void ControlBox::techSubmenuTriggered(QAction* act)
 void ControlBox::infoSubmenuTriggered(QAction* act)
 {
    ui.tabWidget->setCurrentIndex(1);
+   this->assembleStalePages(CMST::Page_Details);
    ui.comboBox_service->setCurrentIndex(ui.comboBox_service->findText(act->text()) );
    this->showNormal();
 
@@ -1684,19 +1843,13 @@ void ControlBox::infoSubmenuTriggered(QAction* act)
 void ControlBox::wifiSubmenuTriggered(QAction* act)
 {
    // find the wifi service associated with the action.
-   for (int i = 0; i < wifi_list.count(); ++i) {
-      if (getNickName(wifi_list.at(i).objpath) == act->text() ) {
-         QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, wifi_list.at(i).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-         QString state = wifi_list.at(i).objmap.value("State").toString();
-         if (state == "online" || state == "ready") {
-            shared::processReply(iface_serv->call(QDBus::AutoDetect, "Disconnect") );
-         }
-         else {
-            iface_serv->setTimeout(5);
-            QDBusMessage reply = iface_serv->call(QDBus::AutoDetect, "Connect");
-            if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply") shared::processReply(reply);
-         } // else
-         iface_serv->deleteLater();
+   for (int i = 0; i < store.wifiCount(); ++i) {
+      if (store.nickName(store.wifiAt(i).objpath) == act->text() ) {
+         NetConnmanServiceInterface* iface_serv = proxies->service(store.wifiAt(i).objpath.path() );
+         if (store.wifiAt(i).isConnected() )
+            shared::processReply(iface_serv->Disconnect() );
+         else
+            watchConnect(iface_serv->Connect() );
          break;
       } // if
    } // for
@@ -1711,21 +1864,13 @@ void ControlBox::wifiSubmenuTriggered(QAction* act)
 void ControlBox::vpnSubmenuTriggered(QAction* act)
 {
    // find the VPN service associated with the action
-   for (int i = 0; i < vpn_list.count(); ++i) {
-      if (getNickName(vpn_list.at(i).objpath) == act->text() ) {
-         QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, vpn_list.at(i).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-         iface_serv->setTimeout(5);
-         QString state = vpn_list.at(i).objmap.value("State").toString();
-         QDBusMessage reply;
-         if (state == "ready")
-            reply = iface_serv->call(QDBus::AutoDetect, "Disconnect");
+   for (int i = 0; i < store.vpnCount(); ++i) {
+      if (store.nickName(store.vpnAt(i).objpath) == act->text() ) {
+         NetConnmanServiceInterface* iface_serv = proxies->service(store.vpnAt(i).objpath.path() );
+         if (store.vpnAt(i).state == ServiceRecord::State_Ready)
+            watchConnect(iface_serv->Disconnect() );
          else
-            reply = iface_serv->call(QDBus::AutoDetect, "Connect" );
-
-         if (reply.errorName() != "org.freedesktop.DBus.Error.NoReply")
-            shared::processReply(reply);
-
-         iface_serv->deleteLater();
+            watchConnect(iface_serv->Connect() );
          break;
       } // if
    } // for
@@ -1734,49 +1879,158 @@ void ControlBox::vpnSubmenuTriggered(QAction* act)
 }
 
 //
-// Slot to get details of the selected service and write it into ui.label_details
-// Called when the ui.comboBox_services currentIndexChanged() signal is emitted.
-void ControlBox::getServiceDetails(int index)
+// Slot called when the vpn internet kill switch was engaged.  The
+// technologies are being powered off, just tell the user.
+void ControlBox::killSwitchEngaged(const QString& vpnname)
 {
-   // Make sure we were sent a valid index, can happen if the comboBox is
-   // cleared and for whatever reason could not be reseeded with entries.
-   if (index < 0 ) return;
+   notifyclient->init();
+   notifyclient->setSummary(tr("VPN Kill Switch Engaged"));
+   notifyclient->setBody(tr("The connection to VPN service %1 was dropped and the VPN kill switch was engaged. All network devices are powered off.").arg(vpnname));
+   this->sendNotifications();
 
-   // variables
-   bool b_editable = services_list.size() > 0 ? true : false;
+   return;
+}
 
-   // Get the QMap associated with the index stored in an arrayElement
-   QMap<QString,QVariant> map = services_list.at(index).objmap;
+//
+// Slot to write the store to the snapshot file.  Called periodically from
+// snapshot_timer and on exit.  Nothing is written while the store still
+// holds the old snapshot or if we could not read it from connman.
+void ControlBox::saveSnapshot()
+{
+   if (b_snapshot) return;
+   if ( (q16_errors & (CMST::Err_No_DBus | CMST::Err_Invalid_Con_Iface | CMST::Err_Properties | CMST::Err_Technologies | CMST::Err_Services)) != 0x00) return;
 
-   // Some of the QVariants in the map are QMaps themselves, create a data structure for them
-   QMap<QString,QVariant> submap;
+   snapshot.save(store);
 
-   // Get a QFileInfo associated with the index and display the connection
-   QFileInfo fi = services_list.at(index).objpath.path();
-   ui.label_details_connection->setText(tr("<b>Connection:</b> %1").arg(fi.baseName()) );
+   return;
+}
 
-   // Start building the string for the left label
-   QString rs = tr("<br><b>Service Details:</b><br>");
-   if (getNickName(services_list.at(index).objpath).isEmpty() ) b_editable = false;
-   rs.append(tr("Service Type: %1<br>").arg(TranslateStrings::cmtr(map.value("Type").toString())) );
-   if (map.value("Type").toString() == "vpn") b_editable = false; // VPN services cannot be edited from here
-   rs.append(tr("Service Name: %1<br>").arg(TranslateStrings::cmtr(map.value("Name").toString())) );
-   rs.append(tr("Service State: %1<br>").arg(TranslateStrings::cmtr(map.value("State").toString())) );
-   rs.append(tr("Favorite: %1<br>").arg(map.value("Favorite").toBool() ? tr("Yes", "favorite") : tr("No", "favorite"))  );
-   rs.append(tr("External Configuration File: %1<br>").arg(map.value("Immutable").toBool() ? tr("Yes", "immutable") : tr("No", "immutable")) );
-   if (map.value("Immutable").toBool() ) b_editable = false;
-   rs.append(tr("Auto Connect: %1<br>").arg(map.value("AutoConnect").toBool() ? tr("On", "autoconnect") : tr("No", "autoconnect")) );
+//
+// Slot to fold the raw traffic log into hourly and daily buckets.  Called
+// periodically from traffic_timer, at startup and on exit.
+void ControlBox::compactTraffic()
+{
+   if (! traffic.compact() ) {
+      openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+      syslog(LOG_WARNING, "%s", tr("Could not write the traffic history in %1").arg(traffic.directory()).toUtf8().constData() );
+      closelog();
+   }
 
-   rs.append(tr("<br><b>IPv4</b><br>"));
-   shared::extractMapData(submap, services_list.at(index).objmap.value("IPv4") );
-   rs.append(tr("IP Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv4 method string")) );
-   rs.append(tr("IP Address: %1<br>").arg(submap.value("Address").toString()));
-   rs.append(tr("IP Netmask: %1<br>").arg(submap.value("Netmask").toString()));
-   rs.append(tr("IP Gateway: %1<br>").arg(submap.value("Gateway").toString()));
+   return;
+}
 
-   rs.append(tr("<br><b>IPv6</b><br>"));
-   shared::extractMapData(submap, services_list.at(index).objmap.value("IPv6") );
-   rs.append(tr("Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv6 method string")) );
+//
+// Slot to save the quota of the service shown on the counters page.  Called
+// when ui.pushButton_quotaapply is pressed.
+void ControlBox::applyQuota()
+{
+   const QString path = quotapath;
+   if (path.isEmpty() ) return;
+
+   Quota quota;
+   quota.limit = static_cast<quint64>(ui.spinBox_quotamb->value()) * 1024 * 1024;
+   quota.period = ui.comboBox_quotaperiod->currentIndex();
+   quota.resetday = ui.spinBox_quotaresetday->value();
+   quota.thresholds = QuotaEngine::parseThresholds(ui.lineEdit_quotathresholds->text() );
+   quota.action = ui.comboBox_quotaaction->currentIndex();
+   quotas->setQuota(path, quota);
+
+   // the quota is kept with the other settings
+   this->writeSettings();
+   this->assembleQuota(path);
+
+   return;
+}
+
+//
+// Slot to send a notification when a service crosses a quota threshold
+void ControlBox::quotaThresholdReached(const QString& path, int percent, quint64 used, quint64 limit)
+{
+   notifyclient->init();
+   notifyclient->setSummary(tr("Data Quota %1% Used").arg(percent) );
+   notifyclient->setBody(tr("Service %1 has used %2 of its %3 quota.").arg(store.nickName(QDBusObjectPath(path))).arg(ConnmanCounter::bytesText(used)).arg(ConnmanCounter::bytesText(limit)) );
+   notifyclient->setIcon(iconman->getIconName("state_error") );
+   this->sendNotifications();
+
+   if (ui.comboBox_counterservice->currentIndex() > COUNTER_ALL || path == onlineobjectpath) scheduleRedraw(CMST::Page_Counters);
+
+   return;
+}
+
+//
+// Slot to send a notification when a service reaches its quota and the
+// action, if any, was taken
+void ControlBox::quotaCapReached(const QString& path, int action)
+{
+   if (action == QuotaEngine::Action_None) return;
+
+   notifyclient->init();
+   notifyclient->setSummary(tr("Data Quota Reached") );
+   notifyclient->setBody(action == QuotaEngine::Action_Disconnect ?
+      tr("Service %1 reached its data quota and was disconnected. AutoConnect is off.").arg(store.nickName(QDBusObjectPath(path))) :
+      tr("Service %1 reached its data quota. AutoConnect is off.").arg(store.nickName(QDBusObjectPath(path))) );
+   notifyclient->setIcon(iconman->getIconName("state_error") );
+   notifyclient->setUrgency(Nc::UrgencyCritical);
+   this->sendNotifications();
+
+   return;
+}
+
+//
+// Slot to redraw the quota of a service when its new period starts
+void ControlBox::quotaPeriodStarted(const QString& path)
+{
+   if (path == quotapath) scheduleRedraw(CMST::Page_Counters);
+
+   return;
+}
+
+//
+// Slot to get details of the selected service and write it into ui.label_details
+// Called when the ui.comboBox_services currentIndexChanged() signal is emitted.
+void ControlBox::getServiceDetails(int index)
+{
+   // Make sure we were sent a valid index, can happen if the comboBox is
+   // cleared and for whatever reason could not be reseeded with entries.
+   // The comboBox is refilled on the next redraw, so it can briefly hold
+   // more entries than the store after a service is removed.
+   if (index < 0 || index >= store.services().size() ) return;
+
+   // variables
+   bool b_editable = store.services().size() > 0 ? true : false;
+
+   // Get the service record associated with the index
+   const ServiceRecord& rec = store.services().at(index);
+
+   // Some of the properties are QMaps themselves, create a data structure for them
+   QMap<QString,QVariant> submap;
+
+   // Get a QFileInfo associated with the index and display the connection
+   QFileInfo fi = rec.objpath.path();
+   ui.label_details_connection->setText(tr("<b>Connection:</b> %1").arg(fi.baseName()) );
+
+   // Start building the string for the left label
+   QString rs = tr("<br><b>Service Details:</b><br>");
+   if (store.nickName(rec.objpath).isEmpty() ) b_editable = false;
+   rs.append(tr("Service Type: %1<br>").arg(TranslateStrings::cmtr(rec.typeString())) );
+   if (rec.type == ServiceRecord::Type_VPN) b_editable = false; // VPN services cannot be edited from here
+   rs.append(tr("Service Name: %1<br>").arg(TranslateStrings::cmtr(rec.name)) );
+   rs.append(tr("Service State: %1<br>").arg(TranslateStrings::cmtr(rec.stateString())) );
+   rs.append(tr("Favorite: %1<br>").arg(rec.favorite ? tr("Yes", "favorite") : tr("No", "favorite"))  );
+   rs.append(tr("External Configuration File: %1<br>").arg(rec.immutable ? tr("Yes", "immutable") : tr("No", "immutable")) );
+   if (rec.immutable ) b_editable = false;
+   rs.append(tr("Auto Connect: %1<br>").arg(rec.autoconnect ? tr("On", "autoconnect") : tr("No", "autoconnect")) );
+
+   rs.append(tr("<br><b>IPv4</b><br>"));
+   submap = rec.ipv4;
+   rs.append(tr("IP Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv4 method string")) );
+   rs.append(tr("IP Address: %1<br>").arg(submap.value("Address").toString()));
+   rs.append(tr("IP Netmask: %1<br>").arg(submap.value("Netmask").toString()));
+   rs.append(tr("IP Gateway: %1<br>").arg(submap.value("Gateway").toString()));
+
+   rs.append(tr("<br><b>IPv6</b><br>"));
+   submap = rec.ipv6;
+   rs.append(tr("Address Acquisition: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ipv6 method string")) );
    rs.append(tr("IP Address: %1<br>").arg(submap.value("Address").toString()));
    QString s_ipv6prefix = submap.value("PrefixLength").toString();
    if (s_ipv6prefix.isEmpty() )
@@ -1787,7 +2041,7 @@ void ControlBox::getServiceDetails(int index)
    rs.append(tr("Privacy: %1<br>").arg(TranslateStrings::cmtr(submap.value("Privacy").toString())) );
 
    rs.append(tr("<br><b>Proxy</b><br>"));
-   shared::extractMapData(submap, services_list.at(index).objmap.value("Proxy") );
+   submap = rec.proxy;
    QString s_proxymethod = TranslateStrings::cmtr(submap.value("Method").toString(), "connman proxy string" );
    rs.append(tr("Address Acquisition: %1<br>").arg(s_proxymethod) );
    if (s_proxymethod == "auto" ) {
@@ -1801,12 +2055,12 @@ void ControlBox::getServiceDetails(int index)
    // mDNS was added in connman 1.38
    if (f_connmanversion > 1.37f) {
       rs.append(tr("<br><b>mDNS</b><br>"));
-      rs.append(tr("Support Enabled: %1<br>").arg(map.value("mDNS").toBool() ? tr("Yes", "mdns") : tr("No", "mdns")) );
+      rs.append(tr("Support Enabled: %1<br>").arg(rec.mdns ? tr("Yes", "mdns") : tr("No", "mdns")) );
    } // connman version
 
    // LastAddressConflict was added in connman 1.38
    if (this->f_connmanversion > 1.37f) {
-      shared::extractMapData(submap, services_list.at(index).objmap.value("LastAddressConflict") );
+      submap = rec.lastaddressconflict;
       if (submap.value("Timestamp").toLongLong() > 0.0) {
          // a map for the maps embedded in submap (IPv4 and Ethernet)
          QMap<QString,QVariant> subsubmap;
@@ -1826,16 +2080,16 @@ void ControlBox::getServiceDetails(int index)
 
    // Start building the string for the right label
    rs = tr("<br><b>Name Servers</b><br>");
-   rs.append(map.value("Nameservers").toStringList().join("<br>") );
+   rs.append(rec.nameservers.join("<br>") );
 
    rs.append(tr("<br><br><b>Time Servers</b><br>  "));
-   rs.append(map.value("Timeservers").toStringList().join("<br>") );
+   rs.append(rec.timeservers.join("<br>") );
 
    rs.append(tr("<br><br><b>Search Domains</b><br>  "));
-   rs.append(map.value("Domains").toStringList().join("<br>") );
+   rs.append(rec.domains.join("<br>") );
 
    rs.append(tr("<br><br><b>Ethernet</b><br>"));
-   shared::extractMapData(submap, services_list.at(index).objmap.value("Ethernet") );
+   submap = rec.ethernet;
    rs.append(tr("Connection Method: %1<br>").arg(TranslateStrings::cmtr(submap.value("Method").toString(), "connman ethernet connection method")) );
    rs.append(tr("Interface: %1<br>").arg(submap.value("Interface").toString()) );
    rs.append(tr("Device Address: %1<br>").arg(submap.value("Address").toString()) );
@@ -1843,20 +2097,29 @@ void ControlBox::getServiceDetails(int index)
 
    rs.append(tr("<br><b>Wireless</b><br>"));
    QStringList sl_tr;
-   for (int i = 0; i < map.value("Security").toStringList().size(); ++i) {
-      sl_tr << TranslateStrings::cmtr(map.value("Security").toStringList().at(i) );
+   const QStringList sl_security = rec.securityStrings();
+   for (int i = 0; i < sl_security.size(); ++i) {
+      sl_tr << TranslateStrings::cmtr(sl_security.at(i) );
    } // for
    rs.append(tr("Security: %1<br>").arg(sl_tr.join(',')) );
-   if (! map.value("Strength").toString().isEmpty() ) rs.append(tr("Strength: %1<br>").arg(map.value("Strength").value<quint8>()) );
-   rs.append(tr("Roaming: %1<br>").arg(map.value("Roaming").toBool() ? tr("Yes", "roaming") : tr("No", "roaming")) );
+   if (rec.strength >= 0) rs.append(tr("Strength: %1<br>").arg(rec.strength) );
+   rs.append(tr("Roaming: %1<br>").arg(rec.roaming ? tr("Yes", "roaming") : tr("No", "roaming")) );
 
    rs.append(tr("<br><b>VPN Provider</b><br>"));
-   shared::extractMapData(submap, services_list.at(index).objmap.value("Provider") );
+   submap = rec.provider;
    rs.append(tr("Host: %1<br>").arg(submap.value("Host").toString()) );
    rs.append(tr("Domain: %1<br>").arg(submap.value("Domain").toString()) );
    rs.append(tr("Name: %1<br>").arg(submap.value("Name").toString()) );
    rs.append(tr("Type: %1<br>").arg(submap.value("Type").toString()) );
 
+   // attempts made by the reconnect scheduler
+   const QStringList reconnects = reconnector->history(rec.objpath.path() );
+   if (! reconnects.isEmpty() ) {
+      rs.append(tr("<br><b>Reconnect Attempts</b><br>"));
+      rs.append(reconnects.join("<br>") );
+      rs.append("<br>");
+   } // if there are reconnect attempts
+
    // write the text to the right display label
    ui.label_details_right->setText(rs);
 
@@ -1893,6 +2156,17 @@ void ControlBox::closeEvent(QCloseEvent* e)
    return;
 }
 
+//
+// Show event for this dialog.  Pages are not rebuilt while we are hidden,
+// so bring the current one up to date before it is painted.
+void ControlBox::showEvent(QShowEvent* e)
+{
+   QDialog::showEvent(e);
+   this->assembleStalePages(this->visiblePage() );
+
+   return;
+}
+
 //
 // Key event for this dialog. If escape is pressed, minimize instead of close if
 // applicable.
@@ -1935,7 +2209,7 @@ void ControlBox::assembleTabStatus()
 {
    // Global Properties
    if ( (q16_errors & CMST::Err_Properties) == 0x00 ) {
-      QString s1 = properties_map.value("State").toString();
+      QString s1 = store.properties().value("State").toString();
       if (s1 == "online") {
          ui.label_state_pix->setPixmap(iconman->getIcon("state_online").pixmap(iconman->getIcon("state_online").actualSize(QSize(16,16) *= iconscale)) );
       } // if online
@@ -1951,7 +2225,7 @@ void ControlBox::assembleTabStatus()
       s1.prepend(tr("State: ") );
       ui.label_state->setText(s1);
 
-      bool b1 = properties_map.value("OfflineMode").toBool();
+      bool b1 = store.properties().value("OfflineMode").toBool();
       QString s2 = QString();
       if (b1) {
          s2 = tr("Engaged");
@@ -1971,140 +2245,44 @@ void ControlBox::assembleTabStatus()
 
    // Technologies
    if ( (q16_errors & CMST::Err_Technologies) == 0x00 ) {
-      QString st = QString();
-      bool bt;
-      ui.tableWidget_technologies->clearContents();
-      ui.tableWidget_technologies->setRowCount(technologies_list.size() );
-      ui.tableWidget_technologies->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Fixed);
-      ui.tableWidget_technologies->horizontalHeader()->setSectionResizeMode(4, QHeaderView::Fixed);
+      technology_model->refresh();
+      ui.tableView_technologies->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Fixed);
+      ui.tableView_technologies->horizontalHeader()->setSectionResizeMode(4, QHeaderView::Fixed);
 
       if (ui.checkBox_hidetethering->isChecked() ) {
-         ui.tableWidget_technologies->hideColumn(4);
-         ui.tableWidget_technologies->hideColumn(5);
+         ui.tableView_technologies->hideColumn(4);
+         ui.tableView_technologies->hideColumn(5);
          ui.pushButton_IDPass->setHidden(true);
       }
       else {
-         ui.tableWidget_technologies->showColumn(4);
-         ui.tableWidget_technologies->showColumn(5);
+         ui.tableView_technologies->showColumn(4);
+         ui.tableView_technologies->showColumn(5);
          ui.pushButton_IDPass->setHidden(false);
       }
 
-      for (int row = 0; row < technologies_list.size(); ++row) {
-         QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-         st = technologies_list.at(row).objmap.value("Name").toString();
-         qtwi00->setText(TranslateStrings::cmtr(st) );
-         qtwi00->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_technologies->setItem(row, 0, qtwi00) ;
-
-         QTableWidgetItem* qtwi01 = new QTableWidgetItem();
-         st = technologies_list.at(row).objmap.value("Type").toString();
-         qtwi01->setText(TranslateStrings::cmtr(st) );
-         qtwi01->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_technologies->setItem(row, 1, qtwi01);
-
-         idButton* qpb02 = new idButton(this, technologies_list.at(row).objpath);
-         connect (qpb02, SIGNAL(clickedID(QString, bool)), this, SLOT(togglePowered(QString, bool)));
-         if (technologies_list.at(row).objmap.value("Powered").toBool()) {
-            qpb02->setText(tr("On", "powered") );
-            qpb02->setIcon(QPixmap(":/icons/images/interface/golfball_green.png"));
-            qpb02->setIconSize(iconscale);
-            qpb02->setChecked(true);
-         }
-         else {
-            qpb02->setText(tr("Off", "powered") );
-            qpb02->setIcon(QPixmap(":/icons/images/interface/golfball_red.png"));
-            qpb02->setIconSize(iconscale);
-            qpb02->setChecked(false); }
-         ui.tableWidget_technologies->setCellWidget(row, 2, qpb02);
-
-         QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-         bt = technologies_list.at(row).objmap.value("Connected").toBool();
-         qtwi03->setText( bt ? tr("Yes", "connected") : tr("No", "connected") );
-         qtwi03->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_technologies->setItem(row, 3, qtwi03);
-
-         idButton* qpb04 = new idButton(this, technologies_list.at(row).objpath);
-         connect (qpb04, SIGNAL(clickedID(QString, bool)), this, SLOT(toggleTethered(QString, bool)));
-         if (technologies_list.at(row).objmap.value("Tethering").toBool()) {
-            qpb04->setText(tr("On", "tethering") );
-            qpb04->setIcon(QPixmap(":/icons/images/interface/golfball_green.png"));
-            qpb02->setIconSize(iconscale);
-            qpb04->setChecked(true);
-         }
-         else {
-            qpb04->setText(tr("Off", "tethering") );
-            qpb04->setIcon(QPixmap(":/icons/images/interface/golfball_red.png"));
-            qpb02->setIconSize(iconscale);
-            qpb04->setChecked(false);
-            if (technologies_list.at(row).objmap.value("Type").toString() == "ethernet")
-               qpb04->setDisabled(true);
-            else
-               qpb04->setEnabled(technologies_list.at(row).objmap.value("Powered").toBool() );
-         }
-         ui.tableWidget_technologies->setCellWidget(row, 4, qpb04);
-
-         QTableWidgetItem* qtwi05 = new QTableWidgetItem();
-         QString sid = technologies_list.at(row).objmap.value("TetheringIdentifier").toString();
-         QString spw = technologies_list.at(row).objmap.value("TetheringPassphrase").toString();
-         if (sid.isEmpty() ) sid = "--";
-         if (spw.isEmpty() ) spw = "--";
-         qtwi05->setText(QString("%1 : %2").arg(sid).arg(spw) );
-         qtwi05->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_technologies->setItem(row, 5, qtwi05);
-
-      } // technologies for loop
-
       // resize the columns to contents
-      ui.tableWidget_technologies->resizeColumnToContents(0);
-      ui.tableWidget_technologies->resizeColumnToContents(1);
-      ui.tableWidget_technologies->resizeColumnToContents(3);
+      ui.tableView_technologies->resizeColumnToContents(0);
+      ui.tableView_technologies->resizeColumnToContents(1);
+      ui.tableView_technologies->resizeColumnToContents(3);
 
    } // technologies if no error
 
    // Services
    if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
-      QString ss = QString();
-      ui.tableWidget_services->clearContents();
-      ui.tableWidget_services->setRowCount(services_list.size() );
+      service_model->refresh();
 
       if (ui.checkBox_hidecnxn->isChecked() ) {
-         ui.tableWidget_services->hideColumn(3);
+         ui.tableView_services->hideColumn(3);
       }
       else {
-         ui.tableWidget_services->showColumn(3);
-         ui.tableWidget_services->horizontalHeader()->resizeSection(1, ui.tableWidget_services->horizontalHeader()->defaultSectionSize());
+         ui.tableView_services->showColumn(3);
+         ui.tableView_services->horizontalHeader()->resizeSection(1, ui.tableView_services->horizontalHeader()->defaultSectionSize());
       }
-      for (int row = 0; row < services_list.size(); ++row) {
-         QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-         ss = getNickName(services_list.at(row).objpath);
-         qtwi00->setText(TranslateStrings::cmtr(ss) );
-         qtwi00->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_services->setItem(row, 0, qtwi00);
-
-         QTableWidgetItem* qtwi01 = new QTableWidgetItem();
-         ss = services_list.at(row).objmap.value("Type").toString();
-         qtwi01->setText(TranslateStrings::cmtr(ss) );
-         qtwi01->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_services->setItem(row, 1, qtwi01);
-
-         QTableWidgetItem* qtwi02 = new QTableWidgetItem();
-         ss = services_list.at(row).objmap.value("State").toString();
-         qtwi02->setText(TranslateStrings::cmtr(ss) );
-         qtwi02->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_services->setItem(row, 2, qtwi02);
-
-         QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-         QFileInfo fi = services_list.at(row).objpath.path();
-         qtwi03->setText(fi.baseName() );
-         qtwi03->setTextAlignment(Qt::AlignVCenter|Qt::AlignLeft);
-         ui.tableWidget_services->setItem(row, 3, qtwi03);
-
-      } // services for loop
 
       // resize the services columns to contents
-      ui.tableWidget_services->resizeColumnToContents(0);
-      ui.tableWidget_services->resizeColumnToContents(1);
-      ui.tableWidget_services->resizeColumnToContents(2);
+      ui.tableView_services->resizeColumnToContents(0);
+      ui.tableView_services->resizeColumnToContents(1);
+      ui.tableView_services->resizeColumnToContents(2);
 
    } // services if no error
 
@@ -2133,8 +2311,8 @@ void ControlBox::assembleTabDetails()
    // services details
    if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
       // populate the combobox
-      for (int row = 0; row < services_list.size(); ++row) {
-         QString ss = getNickName(services_list.at(row).objpath);
+      for (int row = 0; row < store.services().size(); ++row) {
+         QString ss = store.nickName(store.services().at(row).objpath);
          ui.comboBox_service->addItem(TranslateStrings::cmtr(ss) );
          if (TranslateStrings::cmtr(ss) == cursvc)
             newidx = row;
@@ -2149,118 +2327,38 @@ void ControlBox::assembleTabDetails()
 // Function to assemble the wireless tab of the dialog.
 void ControlBox::assembleTabWireless()
 {
-   // If there is a selection save it
-   QString old_sel_item;
-   QList<QTableWidgetItem*> list;
-   list.clear();
-   list = ui.tableWidget_wifi->selectedItems();
-   if (!list.isEmpty() ) old_sel_item = list.at(0)->text();
-
-   // initilize the table
-   ui.tableWidget_wifi->clearContents();
-   ui.tableWidget_wifi->setRowCount(0);
-   int rowcount = 0;
-
-   // Make sure we got the services_list before we try to work with it.
+   // Make sure we got the services list before we try to work with it.
    if ( (q16_errors & CMST::Err_Services) != 0x00 ) return;
 
+   // Bring the wifi table up to date, rows that did not change are not
+   // redrawn and the selection follows the service it was on
+   wifi_model->refresh();
+
    // Run through the technologies again, this time only look for wifi
    if ( (q16_errors & CMST::Err_Technologies) == 0x00 ) {
       int i_wifidevices= 0;
       int i_wifipowered = 0;
-      for (int row = 0; row < technologies_list.size(); ++row) {
-         if (technologies_list.at(row).objmap.value("Type").toString() == "wifi" ) {
+      for (int row = 0; row < store.technologies().size(); ++row) {
+         if (store.technologies().at(row).type == ServiceRecord::Type_Wifi ) {
             ++i_wifidevices;
-            if (technologies_list.at(row).objmap.value("Powered").toBool() ) ++i_wifipowered;
+            if (store.technologies().at(row).powered ) ++i_wifipowered;
          } // if census
       } // for loop
       ui.label_wifi_state->setText(tr("  WiFi Technologies:<br>  %1 Found, %2 Powered").arg(i_wifidevices).arg(i_wifipowered) );
    } // technologis if no errors
 
-   // Run through each services_list looking for wifi services
-   wifi_list.clear();
-
-   for (int row = 0; row < services_list.size(); ++row) {
-      QMap<QString,QVariant> map = services_list.at(row).objmap;
-      if (map.value("Type").toString() == "wifi") {
-         wifi_list.append(services_list.at(row));
-         ui.tableWidget_wifi->setRowCount(rowcount + 1);
-
-         QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-         qtwi00->setText(getNickName(services_list.at(row).objpath) );
-         qtwi00->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_wifi->setItem(rowcount, 0, qtwi00);
-         if (qtwi00->text() == old_sel_item) ui.tableWidget_wifi->selectRow(rowcount);
-
-         QLabel* ql01 = new QLabel(ui.tableWidget_wifi);
-         if (map.value("Favorite").toBool() ) {
-            ql01->setPixmap(iconman->getIcon("favorite").pixmap(QSize(16,16) *= iconscale) );
-         }
-         ql01->setAlignment(Qt::AlignCenter);
-         ui.tableWidget_wifi->setCellWidget(rowcount, 1, ql01);
-
-         QLabel* ql02 = new QLabel(ui.tableWidget_wifi);
-         if (map.value("State").toString() == "online") {
-            ql02->setPixmap(iconman->getIcon("state_online").pixmap(QSize(16,16) *= iconscale) );
-         } // if online
-         else {
-            if (map.value("State").toString() == "ready") {
-               ql02->setPixmap(iconman->getIcon("state_ready").pixmap(QSize(16,16) *= iconscale) );
-            } // if ready
-            else {
-            ql02->setPixmap(iconman->getIcon("wifi_tab_state_not_ready").pixmap(QSize(16,16) *= iconscale) );
-            } // else any other state
-         } // else ready or any other state
-         ql02->setAlignment(Qt::AlignCenter);
-         ql02->setToolTip(TranslateStrings::cmtr(map.value("State").toString()) );
-         ql02->installEventFilter(this);
-         ui.tableWidget_wifi->setCellWidget(rowcount, 2, ql02);
-
-         QTableWidgetItem* qtwi03 = new QTableWidgetItem();
-         QStringList sl_tr;
-         for (int i = 0; i < map.value("Security").toStringList().size(); ++i) {
-            sl_tr << TranslateStrings::cmtr(map.value("Security").toStringList().at(i) );
-         } // for
-         qtwi03->setText(sl_tr.join(',') );
-         qtwi03->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_wifi->setItem(rowcount, 3, qtwi03);
-
-         QProgressBar* pb04 = new QProgressBar(ui.tableWidget_wifi);
-         pb04->setMinimum(0);
-         pb04->setMaximum(100);
-         pb04->setOrientation( Qt::Horizontal);
-         pb04->setValue(map.value("Strength").value<quint8>() );
-         if (QColor(ui.lineEdit_colorize->text()).isValid() ) {
-            QPalette pl = pb04->palette();
-            pl.setColor(QPalette::Active, QPalette::Highlight, QColor(ui.lineEdit_colorize->text()) );
-            pb04->setPalette(pl);
-         }
-
-         QWidget* w04 = new QWidget(ui.tableWidget_wifi);
-         QHBoxLayout* l04 = new QHBoxLayout(w04);
-         l04->addWidget(pb04);
-         w04->setLayout(l04);
-         l04->setAlignment(Qt::AlignCenter);
-         l04->setContentsMargins(7, 5, 11, 5);
-         ui.tableWidget_wifi->setCellWidget(rowcount, 4, w04);
-
-         ++rowcount;
-      } //  if wifi cnxn
-   } // services for loop
-
    // resize the services column 0 to 4 to contents
-   ui.tableWidget_wifi->resizeColumnToContents(0);
-   ui.tableWidget_wifi->resizeColumnToContents(1);
-   ui.tableWidget_wifi->resizeColumnToContents(2);
-   ui.tableWidget_wifi->resizeColumnToContents(3);
+   ui.tableView_wifi->resizeColumnToContents(0);
+   ui.tableView_wifi->resizeColumnToContents(1);
+   ui.tableView_wifi->resizeColumnToContents(2);
+   ui.tableView_wifi->resizeColumnToContents(3);
 
    // enable the control buttons if there is at least on line in the table
    bool b_enable = false;
-   if ( wifi_list.count() > 0 ) b_enable = true;
+   if ( store.wifiCount() > 0 ) b_enable = true;
    ui.pushButton_connect->setEnabled(b_enable);
    ui.pushButton_disconnect->setEnabled(b_enable);
    ui.pushButton_remove->setEnabled(b_enable);
-   setStateRescan(b_enable);
 
    return;
 }
@@ -2269,100 +2367,27 @@ void ControlBox::assembleTabWireless()
 // Function to assemble the VPN tab of the dialog
 void ControlBox::assembleTabVPN()
 {
-   // initilize the table
-   ui.tableWidget_vpn->clearContents();
-   ui.tableWidget_vpn->setRowCount(0);
-   int rowcount = 0;
-
    // Make sure we've been able to communicate with the connman-vpn daemon
    if ( ((q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00) | (vpn_manager == NULL) ) {
       ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
       return;
    }
 
-   // Make sure we got the services_list before we try to work with it.
+   // Make sure we got the services list before we try to work with it.
    if ( (q16_errors & CMST::Err_Services ) != 0x00 ) return;
 
-   // Run through each services_list looking for vpn services
-   vpn_list.clear();
-   for (int row = 0; row < services_list.size(); ++row) {
-      QMap<QString,QVariant> map = services_list.at(row).objmap;
-      if (map.value("Type").toString() == "vpn") {
-         vpn_list.append(services_list.at(row));
-         ui.tableWidget_vpn->setRowCount(rowcount + 1);
-         QMap<QString,QVariant> providermap;
-         shared::extractMapData(providermap, services_list.at(row).objmap.value("Provider") );
-
-         QTableWidgetItem* qtwi00 = new QTableWidgetItem();
-         qtwi00->setText(getNickName(services_list.at(row).objpath) );
-         qtwi00->setTextAlignment(Qt::AlignCenter);
-         ui.tableWidget_vpn->setItem(rowcount, 0, qtwi00);
-
-         QLabel* ql01 = new QLabel(ui.tableWidget_vpn);
-         ql01->setText(TranslateStrings::cmtr(providermap.value("Type").toString()) );
-         ql01->setAlignment(Qt::AlignCenter);
-         ui.tableWidget_vpn->setCellWidget(rowcount, 1, ql01);
-
-         if (map.value("State").toString() == "association") {
-            QProgressBar* pb02 = new QProgressBar(ui.tableWidget_vpn);
-            pb02->setMinimum(0);
-            pb02->setMaximum(0);
-            pb02->setOrientation( Qt::Horizontal);
-            pb02->setFormat("Connecting");
-            // set the stylesheet on pb02
-            QFile f0(":/stylesheets/stylesheets/vpn_connecting.qss");
-            if (f0.open(QIODevice::ReadOnly | QIODevice::Text)) {
-               QString qss = QString(f0.readAll());
-               if (QColor(ui.lineEdit_colorize->text()).isValid() ) {
-                  qss = qss.left(qss.lastIndexOf('}') );
-                  qss.append(QString("background-color: %1;").arg(ui.lineEdit_colorize->text()) );
-                  qss.append('}');
-               }
-               f0.close();
-               pb02->setStyleSheet(qss);
-            }
-
-            ui.tableWidget_vpn->setCellWidget(rowcount, 2, pb02);
-         } // if association
-
-         else {
-            QLabel* ql02 = new QLabel(ui.tableWidget_vpn);
-            if (map.value("State").toString() == "ready") {
-               ql02->setPixmap(iconman->getIcon("state_vpn_connected").pixmap(QSize(16,16) *= iconscale) );
-            } // if ready
-            else {
-               ql02->setPixmap(iconman->getIcon("state_not_ready").pixmap(QSize(16,16) *= iconscale) );
-            } // else any other state
-            ql02->setAlignment(Qt::AlignCenter);
-            ql02->setToolTip(TranslateStrings::cmtr(map.value("State").toString()) );
-            ql02->installEventFilter(this);
-            ui.tableWidget_vpn->setCellWidget(rowcount, 2, ql02);
-         } // else not association
-
-         QLabel* ql03 = new QLabel(ui.tableWidget_vpn);
-         ql03->setText(providermap.value("Host").toString() );
-         ql03->setAlignment(Qt::AlignCenter);
-         ui.tableWidget_vpn->setCellWidget(rowcount, 3, ql03);
-
-         QLabel* ql04 = new QLabel(ui.tableWidget_vpn);
-         QFileInfo fi = services_list.at(row).objpath.path();
-         ql04->setText(fi.baseName() );
-         ql04->setAlignment(Qt:: AlignCenter);
-         ui.tableWidget_vpn->setCellWidget(rowcount, 4, ql04);
-
-         ++rowcount;
-      } // if vpn cnxn
-   } // services for loop
+   // Bring the vpn table up to date
+   vpn_model->refresh();
 
    // resize the services column 0 to 3 to contents
-   ui.tableWidget_vpn->resizeColumnToContents(0);
-   ui.tableWidget_vpn->resizeColumnToContents(1);
-   ui.tableWidget_vpn->resizeColumnToContents(2);
-   ui.tableWidget_vpn->resizeColumnToContents(3);
+   ui.tableView_vpn->resizeColumnToContents(0);
+   ui.tableView_vpn->resizeColumnToContents(1);
+   ui.tableView_vpn->resizeColumnToContents(2);
+   ui.tableView_vpn->resizeColumnToContents(3);
 
    // enable the control buttons if there is at least on line in the table
    bool b_enable = false;
-   if ( vpn_list.count() > 0 ) b_enable = true;
+   if ( store.vpnCount() > 0 ) b_enable = true;
    ui.pushButton_vpn_connect->setEnabled(b_enable);
    ui.pushButton_vpn_disconnect->setEnabled(b_enable);
 
@@ -2378,6 +2403,36 @@ void ControlBox::assembleTabCounters()
       .arg(counter_accuracy)  \
       .arg(counter_period) );
 
+   // services connman has sent counters for, sorted so the list does not jump around
+   QStringList paths = counter->entries().keys();
+   paths.sort();
+
+   // only rebuild the combobox if the services changed, keep the selection
+   bool b_rebuild = ui.comboBox_counterservice->count() != paths.size() + 2;
+   for (int i = 0; ! b_rebuild && i < paths.size(); ++i) {
+      if (ui.comboBox_counterservice->itemData(i + 2).toString() != paths.at(i) ) b_rebuild = true;
+   } // for
+
+   if (b_rebuild) {
+      int curidx = ui.comboBox_counterservice->currentIndex();
+      const QString cursvc = curidx > COUNTER_ALL ? ui.comboBox_counterservice->currentData().toString() : QString();
+
+      ui.comboBox_counterservice->blockSignals(true);
+      ui.comboBox_counterservice->clear();
+      ui.comboBox_counterservice->addItem(tr("Online Service") );
+      ui.comboBox_counterservice->addItem(tr("All Services") );
+      for (int i = 0; i < paths.size(); ++i) {
+         QString ss = store.nickName(QDBusObjectPath(paths.at(i)) );
+         ui.comboBox_counterservice->addItem(ss.isEmpty() ? QFileInfo(paths.at(i)).baseName() : TranslateStrings::cmtr(ss), paths.at(i) );
+      } // for
+
+      if (! cursvc.isEmpty() ) curidx = ui.comboBox_counterservice->findData(cursvc);
+      ui.comboBox_counterservice->setCurrentIndex(curidx < 0 ? COUNTER_ONLINE : curidx);
+      ui.comboBox_counterservice->blockSignals(false);
+   } // if rebuild
+
+   this->showCounters();
+
    return;
 }
 
@@ -2390,10 +2445,10 @@ void ControlBox::assembleTabPreferences()
       // Fill in the combobox for before connect services list
       QString curtext = ui.comboBox_beforeconnectserviceslist->currentText();
       ui.comboBox_beforeconnectserviceslist->clear();
-      for (int row = 0; row < services_list.size(); ++row) {
-         QMap<QString,QVariant> map = services_list.at(row).objmap;
-         if (map.value("Type").toString() == "wifi" || map.value("Type").toString() == "vpn") {
-            QString ss = getNickName(services_list.at(row).objpath);
+      for (int row = 0; row < store.services().size(); ++row) {
+         const ServiceRecord& rec = store.services().at(row);
+         if (rec.type == ServiceRecord::Type_Wifi || rec.type == ServiceRecord::Type_VPN) {
+            QString ss = store.nickName(store.services().at(row).objpath);
             ui.comboBox_beforeconnectserviceslist->addItem(TranslateStrings::cmtr(ss) );
          } // if
       } // services for loop
@@ -2421,90 +2476,116 @@ void ControlBox::assembleTabPreferences()
 void ControlBox::assembleTrayIcon()
 {
    QString stt = QString();
-   int readycount = 0;
-   QIcon prelimicon;
+   QString iconname;
 
    if ( (q16_errors & CMST::Err_Properties & CMST::Err_Services) == 0x00 ) {
-      if ((properties_map.value("State").toString() == "online") || (properties_map.value("State").toString() == "ready") ) {
-         if ( (q16_errors & CMST::Err_Services) == 0x00 ) {
-         QMap<QString,QVariant> submap;
-            if (services_list.at(0).objmap.value("Type").toString() == "ethernet") {
-               shared::extractMapData(submap, services_list.at(0).objmap.value("Ethernet") );
+      if ((store.properties().value("State").toString() == "online") || (store.properties().value("State").toString() == "ready") ) {
+         // GetServices may not have answered yet even though GetProperties has
+         if ( (q16_errors & CMST::Err_Services) == 0x00 && ! store.services().isEmpty() ) {
+            const ServiceRecord& topservice = store.services().at(0);
+            const QMap<QString,QVariant>& submap = topservice.type == ServiceRecord::Type_VPN ? topservice.provider : topservice.ethernet;
+            if (topservice.type == ServiceRecord::Type_Ethernet) {
                stt.prepend(tr("Ethernet Connection\n","icon_tool_tip"));
-               stt.append(tr("Service: %1\n").arg(getNickName(services_list.at(0).objpath)) );
+               stt.append(tr("Service: %1\n").arg(store.nickName(topservice.objpath)) );
                stt.append(tr("Interface: %1").arg(TranslateStrings::cmtr(submap.value("Interface").toString())) );
-               prelimicon = iconman->getIcon("connection_wired");
+               iconname = "connection_wired";
             } // if wired connection
 
-            else if (services_list.at(0).objmap.value("Type").toString() == "wifi") {
+            else if (topservice.type == ServiceRecord::Type_Wifi) {
                stt.prepend(tr("WiFi Connection\n","icon_tool_tip"));
-               shared::extractMapData(submap, services_list.at(0).objmap.value("Ethernet") );
-               stt.append(tr("SSID: %1\n").arg(getNickName(services_list.at(0).objpath)) );
-               QStringList sl_tr;
-               for (int i = 0; i < services_list.at(0).objmap.value("Security").toStringList().size(); ++i) {
-                  sl_tr << TranslateStrings::cmtr(services_list.at(0).objmap.value("Security").toStringList().at(i) );
-               } // for
-               stt.append(tr("Security: %1\n").arg(sl_tr.join(',')) );
-               stt.append(tr("Strength: %1%\n").arg(services_list.at(0).objmap.value("Strength").value<quint8>()) );
+               stt.append(tr("SSID: %1\n").arg(store.nickName(topservice.objpath)) );
+               stt.append(tr("Security: %1\n").arg(TranslateStrings::cmtr_sl(topservice.securityStrings()).join(',')) );
+               stt.append(tr("Strength: %1%\n").arg(topservice.strength) );
                stt.append(tr("Interface: %1").arg(TranslateStrings::cmtr(submap.value("Interface").toString())) );
-               quint8 str = services_list.at(0).objmap.value("Strength").value<quint8>();
-               if (str > 80 ) prelimicon = iconman->getIcon("connection_wifi_100");
-                  else if (str > 60 ) prelimicon = iconman->getIcon("connection_wifi_075");
-                     else if (str > 40 )     prelimicon = iconman->getIcon("connection_wifi_050");
-                        else if (str > 20 )     prelimicon = iconman->getIcon("connection_wifi_025");
-                           else prelimicon = iconman->getIcon("connection_wifi_000");
+               quint8 str = topservice.strength;
+               if (str > 80 ) iconname = "connection_wifi_100";
+                  else if (str > 60 ) iconname = "connection_wifi_075";
+                     else if (str > 40 )     iconname = "connection_wifi_050";
+                        else if (str > 20 )     iconname = "connection_wifi_025";
+                           else iconname = "connection_wifi_000";
             } // else if wifi connection
 
-            else if (services_list.at(0).objmap.value("Type").toString() == "vpn") {
-               shared::extractMapData(submap, services_list.at(0).objmap.value("Provider") );
+            else if (topservice.type == ServiceRecord::Type_VPN) {
                stt.prepend(tr("VPN Connection\n","icon_tool_tip"));
                stt.append(tr("Type: %1\n").arg(TranslateStrings::cmtr(submap.value("Type").toString())) );
-               stt.append(tr("Service: %1\n").arg(services_list.at(0).objmap.value("Name").toString()) );
+               stt.append(tr("Service: %1\n").arg(topservice.name) );
                stt.append(tr("Host: %1").arg(TranslateStrings::cmtr(submap.value("Host").toString())) );
-               prelimicon = iconman->getIcon("connection_vpn");
+               iconname = "connection_vpn";
             } // else if vpn connection
          } // services if no error
       } // if the state is online
 
       // else if state is failure
-      else if (properties_map.value("State").toString() == "failure") {
-         // try to reconnect if service is wifi and Favorite and if reconnect is specified
-         if (ui.checkBox_retryfailed->isChecked() ) {
-            if (services_list.at(0).objmap.value("Type").toString() =="wifi"  && services_list.at(0).objmap.value("Favorite").toBool() ) {
-               QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, services_list.at(0).objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
-               shared::processReply(iface_serv->call(QDBus::AutoDetect, "Connect") );
-               iface_serv->deleteLater();
-               stt.append(tr("Connection is in the Failure State, attempting to reestablish the connection", "icon_tool_tip") );
-            } // if wifi and favorite
-         } // if retry checked
-         prelimicon = iconman->getIcon("connection_failure");
+      else if (store.properties().value("State").toString() == "failure") {
+         // reconnecting is done by the reconnect scheduler, just say so
+         if (store.services().count() > 0 && reconnector->isPending(store.services().at(0).objpath.path()) )
+            stt.append(tr("Connection is in the Failure State, attempting to reestablish the connection", "icon_tool_tip") );
+         iconname = "connection_failure";
          stt.append(tr("Connection is in the Failure State.", "icon_tool_tip"));
       } // else if failure state
 
       // else anything else, states in this case should be "idle", "association", "configuration", or "disconnect"
       else {
-         prelimicon = iconman->getIcon("connection_not_ready");
+         iconname = "connection_not_ready";
          stt.append(tr("Not Connected", "icon_tool_tip"));
       } // else any other connection state
    } // properties if no error
 
    // could not get any properties
    else {
-      prelimicon = iconman->getIcon("connection_error");
+      iconname = "connection_error";
       stt.append(tr("Error retrieving properties via Dbus"));
       stt.append(tr("Connection status is unknown"));
    }
 
-   // Set the tray icon.  If the trayiconbackground color is valid and
-   // there is a valid alpha channel convert the alpha to the backgroundcolor.
-   // Fake transparency can be set as a command line option so trayiconbackground
-   // is set up in the constructor.
-   //
-   // Otherwise just convert the image to ARGB32 which seems to be required
-   // for the icons to display in Plasma5.
-   //
+   // still showing the snapshot from the last run
+   if (b_snapshot) stt.append(tr("\n(Last known state, waiting for connman)", "icon_tool_tip") );
+
+   // Set the tray icon.  The icon is only handed to the tray when it is
+   // different from the one already showing, some panels reload the icon
+   // over DBus on every setIcon() call.
+   const QString key = QString("%1|%2|%3").arg(iconname).arg(trayiconbackground.isValid() ? trayiconbackground.name(QColor::HexArgb) : QString()).arg(iconscale);
+   if (key != trayicon_key) {
+      trayicon->setIcon(renderTrayIcon(iconname, key) );
+      trayicon_key = key;
+   } // if icon changed
+
+   // Set the tool tip (shown when mouse hovers over the systemtrayicon)
+   if (! ui.checkBox_enablesystemtraytooltips->isChecked() ) stt.clear();
+   if (stt != trayicon->toolTip() ) trayicon->setToolTip(stt);
+
+   // Don't continue if we can't get properties
+   if ( (q16_errors & CMST::Err_Properties & CMST::Err_Technologies & CMST::Err_Services) != 0x00 ) return;
+
+   // The submenus are filled in when they are shown, only the ones open
+   // right now need to follow the change.
+   if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL) vpn_submenu->setDisabled(true);
+   QList<QMenu*> menulist = QList<QMenu*>() << tech_submenu << info_submenu << wifi_submenu << vpn_submenu;
+   for (int i = 0; i < menulist.count(); ++i) {
+      if (open_submenus.contains(menulist.at(i)) || menulist.at(i)->isTearOffMenuVisible() )
+         assembleSubmenu(menulist.at(i));
+   } // for
+
+   return;
+}
+
+//
+// Function to return the finished tray icon for an icon name.  key is the
+// cache key built from the name, background color and scale.  If the
+// trayiconbackground color is valid and there is a valid alpha channel
+// convert the alpha to the backgroundcolor.  Fake transparency can be set
+// as a command line option so trayiconbackground is set up in the constructor.
+//
+// Otherwise just convert the image to ARGB32 which seems to be required
+// for the icons to display in Plasma5.
+QIcon ControlBox::renderTrayIcon(const QString& iconname, const QString& key)
+{
+   QHash<QString,QIcon>::const_iterator itr = trayicon_cache.constFind(key);
+   if (itr != trayicon_cache.constEnd() ) return itr.value();
+
    // First convert from a QIcon through QPixmap to QImage
    // QIcon.pixmap(QSize) can return a larger than requested size because AA_UseHighDpiPixmaps is set in main.cpp
+   QIcon prelimicon = iconname.isEmpty() ? QIcon() : iconman->getIcon(iconname);
    QPixmap pxm = prelimicon.pixmap(prelimicon.actualSize((QSize(22,22) *= iconscale)) );
    QImage src = pxm.toImage();
    QImage dest = QImage(src.width(), src.height(), QImage::Format_ARGB32);
@@ -2519,54 +2600,143 @@ void ControlBox::assembleTrayIcon()
    } // else just make an ARGB32 copy
 
    painter.drawImage(0, 0, src);
-   prelimicon = QIcon(QPixmap::fromImage(dest));
-   trayicon->setIcon(prelimicon);
+   painter.end();
 
-   // Set the tool tip (shown when mouse hovers over the systemtrayicon)
-   if (ui.checkBox_enablesystemtraytooltips->isChecked() )
-      trayicon->setToolTip(stt);
-   else
-      trayicon->setToolTip(QString());
+   QIcon icon = QIcon(QPixmap::fromImage(dest));
+   trayicon_cache.insert(key, icon);
+
+   return icon;
+}
+
+//
+// Slot to fill a tray icon submenu when it is about to be shown.  The
+// submenus are not rebuilt on every redraw, most of the time nobody is
+// looking at them.
+void ControlBox::submenuAboutToShow()
+{
+   QMenu* menu = qobject_cast<QMenu*>(sender() );
+   if (menu == NULL) return;
+
+   open_submenus.insert(menu);
+   assembleSubmenu(menu);
+
+   return;
+}
 
+//
+// Slot to note that a tray icon submenu has closed
+void ControlBox::submenuAboutToHide()
+{
+   open_submenus.remove(qobject_cast<QMenu*>(sender()) );
+
+   return;
+}
+
+//
+// Function to assemble the contents of one of the tray icon submenus
+// from the store.  The actions already in the menu are reused so a menu
+// that is open is updated in place.
+void ControlBox::assembleSubmenu(QMenu* menu)
+{
    // Don't continue if we can't get properties
    if ( (q16_errors & CMST::Err_Properties & CMST::Err_Technologies & CMST::Err_Services) != 0x00 ) return;
 
-   // Assemble the submenus for the context menu
+   int count = 0;
+
    // tech_submenu.
-   tech_submenu->clear();
-   for (int i = 0; i < technologies_list.count(); ++i) {
-      QAction* act = tech_submenu->addAction(technologies_list.at(i).objmap.value("Name").toString() );
+   if (menu == tech_submenu) {
+      count = store.technologies().count();
+      assembleTechSubmenu();
+   }
+
+   // info_submenu
+   else if (menu == info_submenu) {
+      count = store.services().count();
+      assembleInfoSubmenu();
+   }
+
+   // wifi_submenu.
+   else if (menu == wifi_submenu) {
+      count = store.wifiCount();
+      assembleWifiSubmenu();
+   }
+
+   // vpn_submenu
+   else if (menu == vpn_submenu) {
+      if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL) return;
+      count = store.vpnCount();
+      assembleVPNSubmenu();
+   }
+
+   else return;
+
+   // drop actions left over from a longer list
+   QList<QAction*> actlist = menu->actions();
+   for (int i = count; i < actlist.count(); ++i) {
+      menu->removeAction(actlist.at(i));
+      actlist.at(i)->deleteLater();
+   } // for
+
+   return;
+}
+
+//
+// Function to return the action at position index in a submenu with
+// its text set.  A new action is added if the menu is not that long yet.
+QAction* ControlBox::submenuAction(QMenu* menu, int index, const QString& text)
+{
+   QList<QAction*> actlist = menu->actions();
+   if (index < actlist.count() ) {
+      actlist.at(index)->setText(text);
+      return actlist.at(index);
+   }
+
+   return menu->addAction(text);
+}
+
+//
+// Function to assemble the technologies submenu
+void ControlBox::assembleTechSubmenu()
+{
+   for (int i = 0; i < store.technologies().count(); ++i) {
+      QAction* act = submenuAction(tech_submenu, i, store.technologies().at(i).name );
       act->setCheckable(true);
-      act->setChecked(technologies_list.at(i).objmap.value("Powered").toBool() );
-      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1 Properties</b></center>").arg(TranslateStrings::cmtr(technologies_list.at(i).objmap.value("Name").toString())) );
-      ttstr.append(tr("Type: %1").arg(technologies_list.at(i).objmap.value("Type").toString()) );
+      act->setChecked(store.technologies().at(i).powered );
+      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1 Properties</b></center>").arg(TranslateStrings::cmtr(store.technologies().at(i).name)) );
+      ttstr.append(tr("Type: %1").arg(store.technologies().at(i).typeString()) );
       ttstr.append(tr("<br>Powered "));
-      technologies_list.at(i).objmap.value("Powered").toBool() ? ttstr.append(tr("On")) : ttstr.append(tr("Off"));
+      store.technologies().at(i).powered ? ttstr.append(tr("On")) : ttstr.append(tr("Off"));
       ttstr.append("<br>");
-      technologies_list.at(i).objmap.value("Connected").toBool() ? ttstr.append(tr("Connected")) : ttstr.append(tr("Not Connected"));
+      store.technologies().at(i).connected ? ttstr.append(tr("Connected")) : ttstr.append(tr("Not Connected"));
       ttstr.append(tr("<br>Tethering "));
-      technologies_list.at(i).objmap.value("Tethering").toBool() ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
+      store.technologies().at(i).tethering ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
       act->setToolTip(ttstr);
    } // i for
 
-   // info_submenu
-   info_submenu->clear();
-   for (int j = 0; j < services_list.count(); ++j) {
-      QAction* act = info_submenu->addAction(getNickName(services_list.at(j).objpath) );
-      if (services_list.at(j).objmap.value("Type").toString() == "ethernet" ) {
-         if (services_list.at(j).objmap.value("State").toString() == "online")
+   return;
+}
+
+//
+// Function to assemble the service details submenu
+void ControlBox::assembleInfoSubmenu()
+{
+   int readycount = 0;
+   for (int j = 0; j < store.services().count(); ++j) {
+      QAction* act = submenuAction(info_submenu, j, store.nickName(store.services().at(j).objpath) );
+      if (store.services().at(j).type == ServiceRecord::Type_Ethernet ) {
+         if (store.services().at(j).state == ServiceRecord::State_Online)
             act->setIcon(iconman->getIcon("connection_wired"));
          else {
-            if(services_list.at(j).objmap.value("State").toString() == "ready")
+            if(store.services().at(j).state == ServiceRecord::State_Ready)
                act->setIcon(iconman->getIcon("connection_ready"));
             else
             act->setIcon(iconman->getIcon("connection_not_ready"));
          } // icon for ready or not ready
       } // if wired
 
-      else if (services_list.at(j).objmap.value("Type").toString() == "wifi" ) {
-         if (services_list.at(j).objmap.value("State").toString() == "online" || (properties_map.value("State").toString() != "online" && (services_list.at(j).objmap.value("State").toString() == "ready" && readycount == 1)) ) {
-            quint8 str = services_list.at(j).objmap.value("Strength").value<quint8>();
+      else if (store.services().at(j).type == ServiceRecord::Type_Wifi ) {
+         if (store.services().at(j).state == ServiceRecord::State_Online || (store.properties().value("State").toString() != "online" && (store.services().at(j).state == ServiceRecord::State_Ready && readycount == 1)) ) {
+            quint8 str = store.services().at(j).strength;
          if (str > 80 ) act->setIcon(iconman->getIcon("connection_wifi_100") );
             else if (str > 60 ) act->setIcon(iconman->getIcon("connection_wifi_075") );
                else if (str > 40 ) act->setIcon(iconman->getIcon("connection_wifi_050") );
@@ -2574,67 +2744,68 @@ void ControlBox::assembleTrayIcon()
                      else act->setIcon(iconman->getIcon("connection_wifi_000") );
          } // if we want to show a wifi signal symbol
          else {
-            if(services_list.at(j).objmap.value("State").toString() == "ready")
+            if(store.services().at(j).state == ServiceRecord::State_Ready)
                act->setIcon(iconman->getIcon("connection_ready"));
             else
                act->setIcon(iconman->getIcon("connection_not_ready"));
          }  // icon for ready or not ready
       } // else if wifi
 
-      else if (services_list.at(j).objmap.value("Type").toString() == "vpn" ) {
-         if (services_list.at(j).objmap.value("State").toString() == "ready")
+      else if (store.services().at(j).type == ServiceRecord::Type_VPN ) {
+         if (store.services().at(j).state == ServiceRecord::State_Ready)
             act->setIcon(iconman->getIcon("connection_vpn"));
          else {
-            if (services_list.at(j).objmap.value("State").toString() == "association")
+            if (store.services().at(j).state == ServiceRecord::State_Association)
                act->setIcon(iconman->getIcon("connection_vpn_acquiring"));
             else
                act->setIcon(iconman->getIcon("connection_not_ready"));
          } // icor for qxquiring or not ready
       } // else if vpn
 
-      else if (services_list.at(j).objmap.value("State").toString() == "ready") act->setIcon(iconman->getIcon("connection_ready"));
-         else if (services_list.at(j).objmap.value("State").toString() == "failure" ) act->setIcon(iconman->getIcon("connection_failure"));
+      else if (store.services().at(j).state == ServiceRecord::State_Ready) act->setIcon(iconman->getIcon("connection_ready"));
+         else if (store.services().at(j).state == ServiceRecord::State_Failure ) act->setIcon(iconman->getIcon("connection_failure"));
             else act->setIcon(iconman->getIcon("connection_not_ready"));
    } // j for
 
-   // wifi_submenu.
-   wifi_submenu->clear();
-   for (int k = 0; k < wifi_list.count(); ++k) {
-      QAction* act = wifi_submenu->addAction(getNickName(wifi_list.at(k).objpath) );
+   return;
+}
+
+//
+// Function to assemble the wifi connections submenu
+void ControlBox::assembleWifiSubmenu()
+{
+   for (int k = 0; k < store.wifiCount(); ++k) {
+      QAction* act = submenuAction(wifi_submenu, k, store.nickName(store.wifiAt(k).objpath) );
       act->setCheckable(true);
-      QString state = wifi_list.at(k).objmap.value("State").toString();
-      if (state == "online" || state == "ready") act->setChecked(true);
-      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(wifi_list.at(k).objpath)) );
+      QString state = store.wifiAt(k).stateString();
+      act->setChecked(store.wifiAt(k).isConnected() );
+      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(store.nickName(store.wifiAt(k).objpath)) );
       ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(state)) );
       ttstr.append("<br>");
-      ttstr.append(tr("Signal Strength: %1%").arg(wifi_list.at(k).objmap.value("Strength").toInt()) );
+      ttstr.append(tr("Signal Strength: %1%").arg(store.wifiAt(k).strength) );
       ttstr.append("<br>");
-      wifi_list.at(k).objmap.value("Favorite").toBool() ? ttstr.append(tr("Favorite Connection")) : ttstr.append(tr("Never Connected"));
+      store.wifiAt(k).favorite ? ttstr.append(tr("Favorite Connection")) : ttstr.append(tr("Never Connected"));
       ttstr.append("<br>");
-      QStringList sl_tr;
-      for (int m = 0; m < wifi_list.at(k).objmap.value("Security").toStringList().size(); ++m) {
-         sl_tr << TranslateStrings::cmtr(wifi_list.at(k).objmap.value("Security").toStringList().at(m) );
-      } // for
-      ttstr.append(tr("Security: %1").arg(sl_tr.join(',')) );
-      if (wifi_list.at(k).objmap.value("Roaming").toBool() ) ttstr.append(tr("<br>Roaming"));
+      ttstr.append(tr("Security: %1").arg(TranslateStrings::cmtr_sl(store.wifiAt(k).securityStrings()).join(',')) );
+      if (store.wifiAt(k).roaming ) ttstr.append(tr("<br>Roaming"));
       ttstr.append(tr("<br>Autoconnect is "));
-      wifi_list.at(k).objmap.value("AutoConnect").toBool() ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
+      store.wifiAt(k).autoconnect ? ttstr.append(tr("Enabled")) : ttstr.append(tr("Disabled"));
       act->setToolTip(ttstr);
    } // k for
 
-   // vpn_submenu
-   if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) != 0x00 || vpn_manager == NULL) {
-      vpn_submenu->setDisabled(true);
-      return;
-   }
+   return;
+}
 
-   vpn_submenu->clear();
-   for (int l = 0; l < vpn_list.count(); ++l) {
-      QAction* act = vpn_submenu->addAction(getNickName(vpn_list.at(l).objpath) );
+//
+// Function to assemble the vpn connections submenu
+void ControlBox::assembleVPNSubmenu()
+{
+   for (int l = 0; l < store.vpnCount(); ++l) {
+      QAction* act = submenuAction(vpn_submenu, l, store.nickName(store.vpnAt(l).objpath) );
       act->setCheckable(true);
-      QString state = vpn_list.at(l).objmap.value("State").toString();
-      if (state == "ready") act->setChecked(true);
-      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(getNickName(vpn_list.at(l).objpath)) );
+      QString state = store.vpnAt(l).stateString();
+      act->setChecked(store.vpnAt(l).state == ServiceRecord::State_Ready);
+      QString ttstr = QString(tr("<p style='white-space:pre'><center><b>%1</b></center>").arg(store.nickName(store.vpnAt(l).objpath)) );
       ttstr.append(tr("Connection : %1").arg(TranslateStrings::cmtr(state)) );
       act->setToolTip(ttstr);
    } // for
@@ -2758,6 +2929,9 @@ void ControlBox::writeSettings()
    settings->setValue("before_connect_service_file", ui.comboBox_beforeconnectservicefile->currentText() );
    settings->endGroup();
 
+   // data quotas
+   quotas->writeSettings(settings);
+
    return;
 }
 
@@ -2840,6 +3014,10 @@ void ControlBox::readSettings()
    ui.spinBox_waittime->setEnabled(ui.checkBox_waittime->isChecked());
    ui.spinBox_counterrate->setEnabled(ui.checkBox_counterseconds->isChecked());
    ui.lineEdit_faketransparency->setEnabled(ui.checkBox_faketransparency->isChecked());
+
+   // data quotas
+   quotas->readSettings(settings);
+
    return;
 }
 
@@ -2854,8 +3032,8 @@ void ControlBox::createSystemTrayIcon()
 {
    if (trayicon != NULL) { // only NULL if the tray icon is disabled in Preferences or on the command line
 
-      // Create the outline of the context menu.   Submenu contents are defined in the
-      // assembletrayIcon() function.
+      // Create the outline of the context menu.   Submenu contents are filled in
+      // by assembleSubmenu() when a submenu is about to be shown.
       trayiconmenu->clear();
       trayiconmenu->setTearOffEnabled(true);
       trayiconmenu->setToolTipsVisible(true);
@@ -2901,7 +3079,7 @@ void ControlBox::createSystemTrayIcon()
 
    // Lastly update the display widgets (since this is actually the last
    // line of the constructor.)
-   this->updateDisplayWidgets();
+   this->scheduleRedraw(CMST::Page_All);
 
    return;
 }
@@ -2931,50 +3109,81 @@ void ControlBox::sendNotifications()
 }
 
 //
-// Function to query connman.manager.GetProperties
-// Return a bool, true on success, false otherwise
-bool ControlBox::getProperties()
+// Function to query connman.manager.GetServices.  The call does not
+// block, the reply is handled in servicesReplied().
+void ControlBox::getServices()
 {
-   // call connman and GetProperties
-   QDBusMessage reply = con_manager->call("GetProperties");
-   shared::processReply(reply);
+   QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(con_manager->GetServices(), this);
+   connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(servicesReplied(QDBusPendingCallWatcher*)));
 
-   // call the function to get the map values
-   properties_map.clear();
-   return getMap(properties_map, reply);
+   return;
 }
 
 //
-// Function to query connman.manager.GetTechnologies
-// Return a bool, true on success, false otherwise
-bool ControlBox::getTechnologies()
+// Function to replace the services list with a GetServices reply.  The
+// list is diffed against the store so the models, the proxy cache, the
+// reconnect scheduler and the counters get the same treatment as after a
+// ServicesChanged signal.
+void ControlBox::replaceServices(const QList<ServiceRecord>& list)
 {
-   // call connman and GetTechnologies
-   QDBusMessage reply = con_manager->call("GetTechnologies");
-   shared::processReply(reply);
+   ChangeSet changes;
+   store.replaceServices(list, changes);
+   killswitch->sync();
+   noteServiceChanges(changes);
+   evictServices(changes);
+   reconnector->sync();
+   quotas->sync();
+   if (! changes.isEmpty() ) scheduleRedraw(CMST::Page_Services);
 
-   // call the function to get the map values
-   technologies_list.clear();
-   return getArray(technologies_list, reply);
+   return;
 }
 
 //
-// Function to query connman.manager.GetServices
-// Return a bool, true on success, false otherwise
-bool ControlBox::getServices()
+// Function to drop the cached proxies, reconnect attempts, counters and
+// strength baselines of the services a change set says are gone.  Rows it
+// says changed are redrawn from the store, so their baselines go too.
+void ControlBox::evictServices(const ChangeSet& changes)
 {
-   // call connman and GetServices
-   QDBusMessage reply = con_manager->call("GetServices");
-   shared::processReply(reply);
+   for (int i = 0; i < changes.changed.size(); ++i) {
+      policy.forget(changes.changed.at(i) );
+   } // for
 
-   // call the function to get the map values
-   services_list.clear();
-   return getArray(services_list, reply);
+   for (int i = 0; i < changes.removed.size(); ++i) {
+      proxies->evict(changes.removed.at(i) );
+      reconnector->remove(changes.removed.at(i) );
+      policy.forget(changes.removed.at(i) );
+      if (rategraph->history() == counter->rates(changes.removed.at(i)) ) rategraph->setHistory(0, ui.comboBox_ratetier->currentIndex() );
+      counter->remove(changes.removed.at(i) );
+   } // for
+
+   return;
 }
 
 //
-// Function to extract arrayElements from a DBus reply message (that contains an array).
-// This data type is returned by GetServices and GetTechnologies.
+// Functions to tell the service models what changed in the services list.
+// Without a change set the models compare every row on the next refresh.
+void ControlBox::noteServiceChanges(const ChangeSet& changes)
+{
+   service_model->addChanges(changes);
+   wifi_model->addChanges(changes);
+   vpn_model->addChanges(changes);
+
+   return;
+}
+
+void ControlBox::noteServiceChanges()
+{
+   service_model->changeAll();
+   wifi_model->changeAll();
+   vpn_model->changeAll();
+
+   return;
+}
+
+//
+// Function to extract arrayElements from a DBus message (that contains an array).
+// Used for the PeersChanged signal, services and technologies are decoded
+// straight into their records (see records.cpp).
 //
 // Return value a bool, true on success, false otherwise
 // A QList of arrayElements is sent by reference (called r_list here)
@@ -3009,38 +3218,6 @@ bool ControlBox::getArray(QList<arrayElement>& r_list, const QDBusMessage& r_msg
    return true;
 }
 
-// Function to extract a QMap from a DBus reply message (that contains a map).
-// This data type is returned by GetProperties
-//
-// Return value a bool, true on success, false otherwise.
-// The map is sent by reference (called r_map here) and is modified by this function.
-// r_msg is a constant reference to the DBus reply message.
-bool ControlBox::getMap(QMap<QString,QVariant>& r_map, const QDBusMessage& r_msg )
-{
-   // make sure r_msg is a QDBusArgument
-   if ( ! r_msg.arguments().at(0).canConvert<QDBusArgument>() ) return false;
-
-   // make sure the QDBusArgument holds a map
-   const QDBusArgument &qdb_arg = r_msg.arguments().at(0).value<QDBusArgument>();
-   if (qdb_arg.currentType() != QDBusArgument::MapType ) return false;
-
-   // iterate over the QDBusArgument pulling map keys and values out
-   qdb_arg.beginMap();
-   r_map.clear();
-
-   while ( ! qdb_arg.atEnd() ) {
-      QString key;
-      QVariant value;
-      qdb_arg.beginMapEntry();
-      qdb_arg >> key >> value;
-      qdb_arg.endMapEntry();
-      r_map.insert(key, value);
-   }
-   qdb_arg.endMap();
-
-   return true;
-}
-
 //
 // Function to log errors to the system log. Functionallity provided
 // by syslog.h and friends.
@@ -3124,64 +3301,300 @@ QString ControlBox::readResourceText(const char* textfile)
 void ControlBox::clearCounters()
 {
    if (ui.checkBox_resetcounters->isChecked() && ! onlineobjectpath.isEmpty() ) {
-      QDBusInterface* iface_serv = new QDBusInterface(DBUS_CON_SERVICE, onlineobjectpath, "net.connman.Service", QDBusConnection::systemBus(), this);
-      shared::processReply(iface_serv->call(QDBus::AutoDetect, "ResetCounters") );
-      iface_serv->deleteLater();
+      shared::processReply(proxies->service(onlineobjectpath)->ResetCounters() );
    }
 
    return;
 }
 
+// Function to find the version of connman running on the local machine.
+// This function starts connmand -v, the version is stored in f_connmanversion
+// by connmanVersionRead() when the process finishes.  f_connmanversion
+// is a float containing the version. Use to enable, disable, hide features
+// of CMST based on what is availabe from connman.  Set to -1.0 if not able
+// to determine a version.
+void ControlBox::findConnmanVersion()
+{
+   QProcess* qps = new QProcess(this);
+   connect(qps, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(connmanVersionRead()));
+   connect(qps, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(connmanVersionRead()));
+   qps->start("connmand", {"-v"});
+
+   return;
+}
+
 //
-// Function to return a nick name for a service. Typically return the
-// Name property.  For wired ethernet Name comes back as Wired, and for
-// hidden wifi networks this is blank. In those cases create a
-// nickname and return it.
-QString ControlBox::getNickName(const QDBusObjectPath& objpath)
+// Slot to read the connman version.  Called when the process started in
+// findConnmanVersion() finishes or fails to start.
+void ControlBox::connmanVersionRead()
 {
-   for (int i = 0; i < services_list.size(); ++i) {
-      if (services_list.at(i).objpath == objpath) {
-         QMap<QString,QVariant> submap;
+   QProcess* qps = qobject_cast<QProcess*>(sender() );
+   if (qps == NULL) return;
 
-         if (services_list.at(i).objmap.value("Type").toString() == "ethernet") {
-            shared::extractMapData(submap, services_list.at(i).objmap.value("Ethernet") );
-            if (submap.value("Interface").toString().isEmpty() )
-               return services_list.at(i).objmap.value("Name").toString();
-            else
-               return QString(TranslateStrings::cmtr(services_list.at(i).objmap.value("Name").toString()) + " [%1]").arg(submap.value("Interface").toString() );
-         } // if type ethernet
+   // a process that crashes signals both error and finished, only read it once
+   disconnect(qps, 0, this, 0);
 
-         else {
-            if ( services_list.at(i).objmap.value("Type").toString() == "wifi" && services_list.at(i).objmap.value("Name").toString().isEmpty() )
-               return tr("[Hidden Wifi]");
-            else
-               return   services_list.at(i).objmap.value("Name").toString();
-         } // else something other than ethernet
+   bool b_ok = false;
+   f_connmanversion = qps->readAllStandardOutput().toFloat(&b_ok);
+   if (! b_ok) f_connmanversion = -1.0;
+   qps->deleteLater();
 
-      } // if objpath matches
-   } // for
+   // the details page shows some properties only for newer versions
+   scheduleRedraw(CMST::Page_Details);
 
-   return QString();
+   return;
 }
 
-// Function to find the version of connman running on the local machine.
-// This function stores f_connmanversion which is a float containing the
-// version. Use to enable, disable, hide features of CMST based on what is
-// availabe from connman.  Set to -1.0 if not able to determine a version.
-void ControlBox::findConnmanVersion()
+//
+// Function to watch a call sent from the constructor.  slot is called
+// with the QDBusPendingCallWatcher when the reply arrives.
+void ControlBox::watchStartupCall(const QDBusPendingCall& call, const char* slot)
+{
+   QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(call, this);
+   connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, slot);
+   ++startup_pending;
+
+   return;
+}
 
+//
+// Function to check the reply to one of the startup calls. If the service
+// we sent it to is not on the bus log err (Err_Invalid_Con_Iface or
+// Err_Invalid_VPN_Iface) once and return false.  Otherwise process the
+// reply as usual and return true.
+bool ControlBox::startupReply(const QDBusMessage& reply, quint16 err)
 {
-   QProcess qps;
-   bool b_ok = false;
+   if (reply.type() == QDBusMessage::ErrorMessage &&
+      (reply.errorName() == "org.freedesktop.DBus.Error.ServiceUnknown" || reply.errorName() == "org.freedesktop.DBus.Error.NameHasNoOwner") ) {
+      if ( (q16_errors & err) == 0x00) {
+         if (err == CMST::Err_Invalid_VPN_Iface) {
+            ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), false);
+            ui.pushButton_vpn_editor->setDisabled(true);
+            ui.checkBox_killswitch->setDisabled(true);
+         } // if vpn
+         logErrors(err);
+         scheduleRedraw(CMST::Page_All);
+      } // if not already logged
+      return false;
+   } // if service not on the bus
 
-   qps.start("connmand", {"-v"});
-   qps.waitForFinished();
-   f_connmanversion = qps.readAllStandardOutput().toFloat(&b_ok);
-   if (! b_ok) f_connmanversion = -1.0;
+   shared::processReply(reply);
+
+   return true;
+}
+
+//
+// Function to send the queries and registrations to connman.  Used at
+// startup and again when connman comes back on the bus.
+void ControlBox::queryConnman()
+{
+   watchStartupCall(con_manager->GetTechnologies(), SLOT(startupTechnologies(QDBusPendingCallWatcher*)));
+   watchStartupCall(con_manager->GetServices(), SLOT(startupServices(QDBusPendingCallWatcher*)));
+   watchStartupCall(con_manager->GetProperties(), SLOT(startupProperties(QDBusPendingCallWatcher*)));
+   watchStartupCall(con_manager->RegisterAgent(QDBusObjectPath(AGENT_OBJECT)), SLOT(startupAgentRegistered(QDBusPendingCallWatcher*)));
+
+   // the signal is connected to the slot when the reply arrives
+   if (b_counters)
+      watchStartupCall(con_manager->RegisterCounter(QDBusObjectPath(CNTR_OBJECT), counter_accuracy, counter_period), SLOT(startupCounterRegistered(QDBusPendingCallWatcher*)));
 
    return;
 }
 
+//
+// Function to send the queries and registrations to connman-vpn
+void ControlBox::queryConnmanVPN()
+{
+   watchStartupCall(vpn_manager->RegisterAgent(QDBusObjectPath(VPN_AGENT_OBJECT)), SLOT(startupVPNAgentRegistered(QDBusPendingCallWatcher*)));
+   watchStartupCall(vpn_manager->GetConnections(), SLOT(startupVPNConnections(QDBusPendingCallWatcher*)));
+
+   return;
+}
+
+//
+// Slot called when connman or connman-vpn leaves or joins the system bus.
+// When one leaves we keep showing what we have, marked as stale.  When it
+// comes back (a restart or an upgrade) the agents and the counter are
+// registered again and the state is queried again.  The replies go through
+// the startup slots.  The services reply is diffed against the store, so
+// services that are gone are evicted and the models only update the rows
+// that changed.
+void ControlBox::connmanOwnerChanged(const QString& name, const QString& oldowner, const QString& newowner)
+{
+   Q_UNUSED(oldowner);
+
+   openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+   if (newowner.isEmpty() ) {
+      syslog(LOG_INFO, "%s left the system bus", qPrintable(name) );
+      closelog();
+      if (name == DBUS_CON_SERVICE) {
+         b_snapshot = true;
+         scheduleRedraw(CMST::Page_TrayIcon);
+      } // if connman
+      return;
+   } // if gone
+
+   syslog(LOG_INFO, "%s joined the system bus, resynchronizing", qPrintable(name) );
+   closelog();
+
+   if (startup_pending == 0) startup_timer.restart();
+   b_resync = true;
+
+   if (name == DBUS_CON_SERVICE) {
+      q16_errors &= ~(CMST::Err_Invalid_Con_Iface | CMST::Err_Properties | CMST::Err_Technologies | CMST::Err_Services);
+      proxies->clear();
+      this->queryConnman();
+      this->findConnmanVersion();
+   } // if connman
+
+   else if (name == DBUS_VPN_SERVICE && vpn_manager != NULL) {
+      q16_errors &= ~CMST::Err_Invalid_VPN_Iface;
+      ui.tabWidget->setTabEnabled(ui.tabWidget->indexOf(ui.VPN), true);
+      ui.pushButton_vpn_editor->setEnabled(true);
+      ui.checkBox_killswitch->setEnabled(true);
+      this->queryConnmanVPN();
+   } // else if connman-vpn
+
+   return;
+}
+
+//
+// Function called as each startup call is finished.  When the last one is
+// in log how long the startup took.
+void ControlBox::startupCallFinished()
+{
+   if (--startup_pending > 0) return;
+
+   // Whatever the startup queries did not replace came from the snapshot.
+   // If connman is not there at all don't keep showing it.
+   if (b_snapshot) {
+      b_snapshot = false;
+      if ( (q16_errors & CMST::Err_Invalid_Con_Iface) != 0x00) {
+         store.clear();
+         noteServiceChanges();
+      } // if connman is not there
+      scheduleRedraw(CMST::Page_All);
+   } // if showing the snapshot
+
+   openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+   if (b_resync)
+      syslog(LOG_INFO, "Resynchronized with connman in %lld ms", static_cast<long long>(startup_timer.elapsed()) );
+   else
+      syslog(LOG_INFO, "Startup took %lld ms, constructor %lld ms", static_cast<long long>(startup_timer.elapsed()), static_cast<long long>(startup_ctor_ms) );
+   closelog();
+   b_resync = false;
+
+   return;
+}
+
+//
+// Slots to process the replies to the calls sent from the constructor
+void ControlBox::startupTechnologies(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusPendingReply<QList<TechnologyRecord> > reply = *watcher;
+   watcher->deleteLater();
+
+   if (startupReply(reply.reply(), CMST::Err_Invalid_Con_Iface) ) {
+      if (reply.isError() ) logErrors(CMST::Err_Technologies);
+      else {
+         store.setTechnologies(reply.value() );
+         scheduleRedraw(CMST::Page_Status | CMST::Page_Wireless | CMST::Page_TrayIcon);
+      } // else
+   } // if reply
+
+   startupCallFinished();
+   return;
+}
+
+void ControlBox::startupServices(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusPendingReply<QList<ServiceRecord> > reply = *watcher;
+   watcher->deleteLater();
+
+   if (startupReply(reply.reply(), CMST::Err_Invalid_Con_Iface) ) {
+      if (reply.isError() ) logErrors(CMST::Err_Services);
+      else {
+         // diffed against the store, services that vanished while connman
+         // was away (or since the snapshot) are evicted like any removal
+         replaceServices(reply.value() );
+      } // else
+   } // if reply
+
+   startupCallFinished();
+   return;
+}
+
+//
+// Slot to process the reply to a GetServices call sent by getServices()
+void ControlBox::servicesReplied(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusPendingReply<QList<ServiceRecord> > reply = *watcher;
+   watcher->deleteLater();
+
+   shared::processReply(reply.reply() );
+   if (! reply.isError() ) replaceServices(reply.value() );
+
+   return;
+}
+
+void ControlBox::startupProperties(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusPendingReply<QVariantMap> reply = *watcher;
+   watcher->deleteLater();
+
+   if (startupReply(reply.reply(), CMST::Err_Invalid_Con_Iface) ) {
+      if (reply.isError() ) logErrors(CMST::Err_Properties);
+      else {
+         store.setProperties(reply.value() );
+         scheduleRedraw(CMST::Page_All);
+      } // else
+   } // if reply
+
+   startupCallFinished();
+   return;
+}
+
+void ControlBox::startupAgentRegistered(QDBusPendingCallWatcher* watcher)
+{
+   startupReply(watcher->reply(), CMST::Err_Invalid_Con_Iface);
+   watcher->deleteLater();
+
+   startupCallFinished();
+   return;
+}
+
+void ControlBox::startupCounterRegistered(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusMessage reply = watcher->reply();
+   watcher->deleteLater();
+
+   if (startupReply(reply, CMST::Err_Invalid_Con_Iface) && reply.type() == QDBusMessage::ReplyMessage)
+      connect(counter, SIGNAL(usageUpdated(QDBusObjectPath)), this, SLOT(counterUpdated(QDBusObjectPath)), Qt::UniqueConnection);
+
+   startupCallFinished();
+   return;
+}
+
+void ControlBox::startupVPNAgentRegistered(QDBusPendingCallWatcher* watcher)
+{
+   startupReply(watcher->reply(), CMST::Err_Invalid_VPN_Iface);
+   watcher->deleteLater();
+
+   startupCallFinished();
+   return;
+}
+
+void ControlBox::startupVPNConnections(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusPendingReply<QList<arrayElement> > reply = *watcher;
+   watcher->deleteLater();
+
+   if (startupReply(reply.reply(), CMST::Err_Invalid_VPN_Iface) && ! reply.isError() )
+      store.setVPNConnections(reply.value() );
+
+   startupCallFinished();
+   return;
+}
+
 // Slot to connect to the notification client. Called from QTimers to give time for the notification server
 // to start up if this program is started automatically at boot.  We make four attempts at finding the
 // notification server.  First is in the constructor of NotifyClient, following we call the connectToServer()
@@ -3247,7 +3660,7 @@ void ControlBox::configureService()
    if (ui.comboBox_service->currentIndex() < 0 ) return;
 
    // Create a new properties editor
-   PropertiesEditor* peditor = new PropertiesEditor(this, services_list.at(ui.comboBox_service->currentIndex()) );
+   PropertiesEditor* peditor = new PropertiesEditor(this, store.services().at(ui.comboBox_service->currentIndex()) );
    if (f_connmanversion <= 1.37f) peditor->setItemEnabled(7, false);
 
    // Set the whatsthis button icon
@@ -3314,23 +3727,32 @@ void ControlBox::cleanUp()
    this->writeSettings();
 
    // unregister objects
-   if (con_manager->isValid() ) {
+   if (con_manager != NULL && (q16_errors & CMST::Err_Invalid_Con_Iface) == 0x00 ) {
       // agent
-      shared::processReply(con_manager->call(QDBus::AutoDetect, "UnregisterAgent", QVariant::fromValue(QDBusObjectPath(AGENT_OBJECT))) );
+      shared::processReply(con_manager->UnregisterAgent(QDBusObjectPath(AGENT_OBJECT)) );
       // counter - only have a signal-slot connection if the counter was able to be registered
       if (counter->cnxns() > 0) {
-         shared::processReply(con_manager->call(QDBus::AutoDetect, "UnregisterCounter", QVariant::fromValue(QDBusObjectPath(CNTR_OBJECT))) );
+         shared::processReply(con_manager->UnregisterCounter(QDBusObjectPath(CNTR_OBJECT)) );
       } // if counters are connected to anything
 
 
       if (vpn_manager != NULL) {
-         if (vpn_manager->isValid() ) {
-            shared::processReply(vpn_manager->call(QDBus::AutoDetect, "UnregisterAgent", QVariant::fromValue(QDBusObjectPath(VPN_AGENT_OBJECT))) );
+         if ( (q16_errors & CMST::Err_Invalid_VPN_Iface) == 0x00 ) {
+            shared::processReply(vpn_manager->UnregisterAgent(QDBusObjectPath(VPN_AGENT_OBJECT)) );
          } // ivpn_manager isValid
       } // not null
 
    } // if con_manager isValid
 
+   // save the state for the next start
+   this->saveSnapshot();
+   this->compactTraffic();
+
+   // log how many service property changes were redrawn
+   openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+   syslog(LOG_INFO, "Service property changes: %u redrawn, %u suppressed", policy.applied(), policy.suppressed() );
+   closelog();
+
    return;
 }
 
@@ -3357,7 +3779,14 @@ void ControlBox::callColorDialog(QAction* act)
 void ControlBox::iconColorChanged(const QString& col)
 {
    iconman->setIconColor(QColor(col) );
-   this->updateDisplayWidgets();
+   trayicon_cache.clear();
+   trayicon_key.clear();
+   delegate->setHighlight(QColor(col) );
+   technology_model->invalidate();
+   service_model->invalidate();
+   wifi_model->invalidate();
+   vpn_model->invalidate();
+   this->scheduleRedraw(CMST::Page_All);
    ui.toolButton_whatsthis->setIcon(iconman->getIcon("whats_this"));
    agent->setWhatsThisIcon(iconman->getIcon("whats_this"));
    vpnagent->setWhatsThisIcon(iconman->getIcon("whats_this"));
@@ -36,6 +36,8 @@ DEALINGS IN THE SOFTWARE.
 # include <QDialog>
 # include <QString>
 # include <QMap>
+# include <QHash>
+# include <QSet>
 # include <QVariant>
 # include <QSystemTrayIcon>
 # include <QAction>
@@ -48,47 +50,34 @@ DEALINGS IN THE SOFTWARE.
 # include <QProgressBar>
 # include <QColor>
 # include <QToolButton>
+# include <QTimer>
+# include <QElapsedTimer>
+# include <QDBusPendingCallWatcher>
+# include <QDBusServiceWatcher>
 
 # include "ui_controlbox.h"
+# include "../resource.h"
 # include "./code/agent/agent.h"
 # include "./code/counter/counter.h"
 # include "./code/notify/notify.h"
 # include "./code/iconman/iconman.h"
 # include "./code/vpn_agent/vpnagent.h"
 # include "./code/gen_conf_ed/gen_conf_ed.h"
+# include "./code/store/store.h"
+# include "./code/shared/shared.h"
+# include "./code/proxycache/proxycache.h"
+# include "./code/policy/updatepolicy.h"
+# include "./code/reconnect/reconnect.h"
+# include "./code/killswitch/killswitch.h"
+# include "./code/snapshot/snapshot.h"
+# include "./code/rategraph/rategraph.h"
+# include "./code/traffic/traffichistory.h"
+# include "./code/quota/quota.h"
+# include "manager_interface.h"
+# include "vpnmanager_interface.h"
+# include "./code/models/models.h"
+# include "./code/models/delegate.h"
 
-// Two of the connman.Manager query functions will return an array of structures.
-// This struct provides a receiving element we can use to collect the return data.
-struct arrayElement
-{
-   QDBusObjectPath objpath;
-   QMap<QString,QVariant> objmap;
-};
-
-
-//
-// custom QFrame containing a QToolButton that will emit a button id
-class idButton : public QFrame
-{
-   Q_OBJECT
-
-   public:
-      idButton (QWidget*, const QDBusObjectPath&);
-      inline void setText (const QString& text) {button->setText(text);}
-      inline void setIcon (const QPixmap& pixmap) {button->setIcon(pixmap);}
-      inline void setIconSize (float sz) {button->setIconSize(button->icon().actualSize(QSize(12,12) *= sz) ); }
-      inline void setChecked (bool checked) {button->setChecked(checked);}
-
-   signals:
-      void clickedID(QString, bool);
-
-   private:
-      QToolButton* button;
-      QDBusObjectPath obj_id;
-
-   private slots:
-      void buttonClicked(bool);
-};
 
 //
 // The main program class based on a QDialog
@@ -108,6 +97,7 @@ class ControlBox : public QDialog
 
    protected:
       void closeEvent(QCloseEvent*);
+      void showEvent(QShowEvent*);
       void keyPressEvent(QKeyEvent*);
       bool eventFilter(QObject*, QEvent*);
 
@@ -115,22 +105,30 @@ class ControlBox : public QDialog
       // members
       Ui::ControlBox ui;
       quint16 q16_errors;
-      QMap<QString,QVariant>  properties_map;
-      QList<arrayElement>  services_list;
-      QList<arrayElement> technologies_list;
-      QList<arrayElement> wifi_list;
-      QList<arrayElement> peer_list;
-      QList<arrayElement> vpn_list;       // extracted from our services list
-      QList<arrayElement> vpnconn_list;   // from vpn manager used for signals and slots
+      ConnmanStore store;
       ConnmanAgent* agent;
       ConnmanVPNAgent* vpnagent;
       ConnmanCounter* counter;
+      RateGraph* rategraph;
       NotifyClient* notifyclient;
       short wifi_interval;
       quint32 counter_accuracy;
       quint32 counter_period;
-      QDBusInterface* con_manager;
-      QDBusInterface* vpn_manager;
+      NetConnmanManagerInterface* con_manager;
+      NetConnmanVpnManagerInterface* vpn_manager;
+      ProxyCache* proxies;
+      ReconnectScheduler* reconnector;
+      KillSwitch* killswitch;
+      StoreSnapshot snapshot;
+      bool b_snapshot;
+      QTimer* snapshot_timer;
+      TrafficHistory traffic;
+      QTimer* traffic_timer;
+      QuotaEngine* quotas;
+      QString quotapath;
+      QDBusServiceWatcher* connman_watcher;
+      bool b_resync;
+      bool b_counters;
       QSystemTrayIcon*  trayicon;
       QMenu* trayiconmenu;
       QMenu* tech_submenu;
@@ -138,6 +136,7 @@ class ControlBox : public QDialog
       QMenu* wifi_submenu;
       QMenu* vpn_submenu;
       QMenu* mvsrv_menu;
+      QSet<QMenu*> open_submenus;
       QActionGroup* minMaxGroup;
       QActionGroup* moveGroup;
       QActionGroup* colorGroup;
@@ -153,12 +152,29 @@ class ControlBox : public QDialog
       QString pendingobjectpath;
       QLocalServer* socketserver;
       QColor trayiconbackground;
+      QHash<QString,QIcon> trayicon_cache;
+      QString trayicon_key;
       IconManager* iconman;
       float f_connmanversion;
       GEN_Editor* gened;
       QProcess* proc;
       bool b_userinitiated;
       float iconscale;
+      QTimer* redraw_timer;
+      QTimer* counter_timer;
+      bool b_counterpending;
+      quint16 q16_dirty;
+      quint16 q16_stale;
+      short startup_pending;
+      QElapsedTimer startup_timer;
+      qint64 startup_ctor_ms;
+      short scans_pending;
+      UpdatePolicy policy;
+      TechnologyModel* technology_model;
+      ServiceModel* service_model;
+      WifiModel* wifi_model;
+      VPNModel* vpn_model;
+      StoreDelegate* delegate;
 
       // functions
       void assembleTabStatus();
@@ -167,25 +183,58 @@ class ControlBox : public QDialog
       void assembleTabVPN();
       void assembleTabCounters();
       void assembleTabPreferences();
+      void assembleStalePages(quint16);
+      quint16 visiblePage();
       void assembleTrayIcon();
+      QIcon renderTrayIcon(const QString&, const QString&);
+      void assembleSubmenu(QMenu*);
+      QAction* submenuAction(QMenu*, int, const QString&);
+      void assembleTechSubmenu();
+      void assembleInfoSubmenu();
+      void assembleWifiSubmenu();
+      void assembleVPNSubmenu();
       void sendNotifications();
-      bool getProperties();
-      bool getTechnologies();
-      bool getServices();
+      void getServices();
+      void replaceServices(const QList<ServiceRecord>&);
+      void evictServices(const ChangeSet&);
       bool getArray(QList<arrayElement>&, const QDBusMessage&);
-      bool getMap(QMap<QString,QVariant>&, const QDBusMessage&);
       void logErrors(const quint16&);
       QString readResourceText(const char*);
       void clearCounters();
-      QString getNickName(const QDBusObjectPath&);
       void findConnmanVersion();
+      void watchStartupCall(const QDBusPendingCall&, const char*);
+      bool startupReply(const QDBusMessage&, quint16);
+      void startupCallFinished();
+      void queryConnman();
+      void queryConnmanVPN();
+      void assembleUsage(const QString&, bool);
+      void assembleQuota(const QString&);
+      void watchConnect(const QDBusPendingCall&);
+      void noteServiceChanges(const ChangeSet&);
+      void noteServiceChanges();
+      QString selectedPath(QTableView*);
 
    private slots:
+      void startupTechnologies(QDBusPendingCallWatcher*);
+      void startupServices(QDBusPendingCallWatcher*);
+      void startupProperties(QDBusPendingCallWatcher*);
+      void startupAgentRegistered(QDBusPendingCallWatcher*);
+      void startupCounterRegistered(QDBusPendingCallWatcher*);
+      void startupVPNAgentRegistered(QDBusPendingCallWatcher*);
+      void startupVPNConnections(QDBusPendingCallWatcher*);
+      void servicesReplied(QDBusPendingCallWatcher*);
+      void connmanVersionRead();
+      void connmanOwnerChanged(const QString&, const QString&, const QString&);
+      void connectReplied(QDBusPendingCallWatcher*);
+      void scanFinished(QDBusPendingCallWatcher*);
+      void scheduleRedraw(quint16 pages = CMST::Page_All);
       void updateDisplayWidgets();
       void moveService(QAction*);
       void moveButtonPressed(QAction*);
-      void enableMoveButtons(int,int);
-      void counterUpdated(const QDBusObjectPath&, const QString&, const QString&);
+      void enableMoveButtons(const QModelIndex&);
+      void counterUpdated(const QDBusObjectPath&);
+      void showCounters();
+      void counterRefresh();
       void connectPressed();
       void requestConnection();
       void disconnectPressed();
@@ -211,12 +260,25 @@ class ControlBox : public QDialog
       void infoSubmenuTriggered(QAction* = 0);
       void wifiSubmenuTriggered(QAction* = 0);
       void vpnSubmenuTriggered(QAction* = 0);
+      void submenuAboutToShow();
+      void submenuAboutToHide();
+      void killSwitchEngaged(const QString&);
+      void saveSnapshot();
+      void compactTraffic();
+      void applyQuota();
+      void quotaThresholdReached(const QString&, int, quint64, quint64);
+      void quotaCapReached(const QString&, int);
+      void quotaPeriodStarted(const QString&);
       void getServiceDetails(int);
       void showWhatsThis();
       inline void trayNotifications(bool checked) {if (checked) ui.checkBox_notifydaemon->setChecked(false);}
       inline void daemonNotifications(bool checked) {if (checked) ui.checkBox_systemtraynotifications->setChecked(false);}
-      inline void iconFullHide(bool checked) {if (checked) ui.checkBox_hideIconAuto->setChecked(false); updateDisplayWidgets();}
-      inline void iconPartialHide(bool checked) {if (checked) ui.checkBox_hideIconFull->setChecked(false);updateDisplayWidgets();}
+      inline void iconFullHide(bool checked) {if (checked) ui.checkBox_hideIconAuto->setChecked(false); scheduleRedraw(CMST::Page_TrayIcon);}
+      inline void iconPartialHide(bool checked) {if (checked) ui.checkBox_hideIconFull->setChecked(false); scheduleRedraw(CMST::Page_TrayIcon);}
+      inline void statusOptionsChanged() {scheduleRedraw(CMST::Page_Status);}
+      inline void currentPageChanged() {assembleStalePages(visiblePage());}
+      inline void trayOptionsChanged() {scheduleRedraw(CMST::Page_TrayIcon);}
+      inline void reconnectHistoryChanged() {scheduleRedraw(CMST::Page_Details);}
       inline void closeSystemTrayTearOffMenu() {trayiconmenu->hideTearOffMenu();}
       void iconActivated(QSystemTrayIcon::ActivationReason reason);
       void enableRunOnStartup(bool enabled);
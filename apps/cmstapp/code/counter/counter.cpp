@@ -41,8 +41,9 @@ ConnmanCounter::ConnmanCounter(QObject* parent)
     : QObject(parent)
 { 
   //  data members
-  home_data = QVariantMap();
-  roam_data = QVariantMap();
+  counters.clear();
+  histories.clear();
+  clock.start();
   
   //  Create Adaptor and register this Counter on the system bus.  
   new CounterAdaptor(this);
@@ -53,48 +54,77 @@ ConnmanCounter::ConnmanCounter(QObject* parent)
 }
 
 
+/////////////////////////////////////// COUNTER DATA ////////////////////////////////
+//
+// Function to copy the fields connman sent into the typed members.  Fields
+// not in the map keep their old value.
+void CounterData::merge(const QVariantMap& map)
+{
+  static const struct {const char* key; quint64 CounterData::* field;} fields[] = {
+    {"RX.Packets", &CounterData::rx_packets},
+    {"RX.Bytes", &CounterData::rx_bytes},
+    {"RX.Errors", &CounterData::rx_errors},
+    {"RX.Dropped", &CounterData::rx_dropped},
+    {"TX.Packets", &CounterData::tx_packets},
+    {"TX.Bytes", &CounterData::tx_bytes},
+    {"TX.Errors", &CounterData::tx_errors},
+    {"TX.Dropped", &CounterData::tx_dropped},
+    {"Time", &CounterData::time}
+  };
+
+  QVariantMap::const_iterator i;
+  for (uint n = 0; n < sizeof(fields) / sizeof(fields[0]); ++n) {
+    i = map.constFind(QLatin1String(fields[n].key) );
+    if (i != map.constEnd() ) this->*fields[n].field = i.value().toULongLong();
+  } // for
+
+  return;
+}
+
+//
+// Function to add the counters of another service.  Packets and bytes are
+// summed, the connect time is the longest of the two.
+CounterData& CounterData::operator+=(const CounterData& other)
+{
+  rx_packets += other.rx_packets;
+  rx_bytes += other.rx_bytes;
+  rx_errors += other.rx_errors;
+  rx_dropped += other.rx_dropped;
+  tx_packets += other.tx_packets;
+  tx_bytes += other.tx_bytes;
+  tx_errors += other.tx_errors;
+  tx_dropped += other.tx_dropped;
+  if (other.time > time) time = other.time;
+
+  return *this;
+}
+
 /////////////////////////////////////// PUBLIC FUNCTIONS ////////////////////////////////
 //
 //  Function to return a QString for display in a label
-//  map is the member map (home_data or roam_data) we wish to get
-QString ConnmanCounter::getLabel(const QVariantMap& map)
+//  data is the home or roaming counters we wish to get
+QString ConnmanCounter::getLabel(const CounterData& data)
 { 
   // Set TX bytes to Bytes, KB, MB, or GB depending on size
-  const int b_cutoff = 1024 * 1.875       ; // size in Bytes to change units from Bytes to KB
-  const int k_cutoff = 1024 * 1024 * 1.875 ; // size in Bytes to change units from KB to MB
-  const int m_cutoff = 1024 * 1024 * 1024 * 1.875 ; // size in Bytes to change units from MB to GB
-  QString datafield;
-  if (map.value("TX.Bytes").toLongLong() < b_cutoff ) datafield = tr("%L1 Bytes").arg(map.value("TX.Bytes").toLongLong());
-  else if (map.value("TX.Bytes").toLongLong() <  k_cutoff)                                                      
-    datafield = tr("%L1 KB").arg(static_cast<double>(map.value("TX.Bytes").toLongLong()) / (1024), 0, 'f', 1);  
-      else if (map.value("TX.Bytes").toLongLong() <  m_cutoff)                                                      
-        datafield = tr("%L1 MB").arg(static_cast<double>(map.value("TX.Bytes").toLongLong()) / (1024 * 1024), 0, 'f', 1); 
-          else 
-            datafield = tr("%L1 GB").arg(static_cast<double>(map.value("TX.Bytes").toLongLong()) / (1024 * 1024 * 1024), 0, 'f', 1);  
+  QString datafield = bytesText(data.tx_bytes);
 
   // Create a label with the total number of packets [errors and dropped] sent.
   QString rtn = tr("<b>Transmit:</b><br>TX Total: %1 (%2),  TX Errors: %3,  TX Dropped: %4")
-                            .arg(tr("%Ln Packet(s)", 0, map.value("TX.Packets").toLongLong()) ) 
+                            .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.tx_packets)) ) 
                             .arg(datafield)                                                   
-                            .arg(tr("%Ln Packet(s)", 0, map.value("TX.Errors").toLongLong()) )  
-                            .arg(tr("%Ln Packet(s)", 0, map.value("TX.Dropped").toLongLong()) ) ;
+                            .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.tx_errors)) )  
+                            .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.tx_dropped)) ) ;
 
 
   // Set RX data bytes to Bytes, KB, MB or GB
-  if (map.value("RX.Bytes").toLongLong() < b_cutoff ) datafield = tr("%L1 Bytes").arg(map.value("RX.Bytes").toLongLong());
-  else if (map.value("RX.Bytes").toLongLong() <  k_cutoff)                                                      
-    datafield = tr("%L1 KB").arg(static_cast<double>(map.value("RX.Bytes").toLongLong()) / (1024), 0, 'f', 1);  
-      else if (map.value("RX.Bytes").toLongLong() <  m_cutoff)                                                      
-        datafield = tr("%L1 MB").arg(static_cast<double>(map.value("RX.Bytes").toLongLong()) / (1024 * 1024), 0, 'f', 1); 
-          else 
-            datafield = tr("%L1 GB").arg(static_cast<double>(map.value("RX.Bytes").toLongLong()) / (1024 * 1024 * 1024), 0, 'f', 1);  
+  datafield = bytesText(data.rx_bytes);
 
   // Append to the label the total number of packets [errors and dropped] received.
   rtn.append(tr("<br><br><b>Received:</b><br>RX Total: %1 (%2),  RX Errors: %3,  RX Dropped: %4")             
-                              .arg(tr("%Ln Packet(s)", 0, map.value("RX.Packets").toLongLong()) )   
+                              .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.rx_packets)) )   
                               .arg(datafield)                                                     
-                              .arg(tr("%Ln Packet(s)", 0, map.value("RX.Errors").toLongLong()) )  
-                              .arg(tr("%Ln Packet(s)", 0, map.value("RX.Dropped").toLongLong())) );     
+                              .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.rx_errors)) )  
+                              .arg(tr("%Ln Packet(s)", 0, static_cast<int>(data.rx_dropped))) );     
   
   // Append the time title
   rtn.append(tr("<br><br><b>Connect Time:</b><br>") );                                                                                                                                                                              
@@ -105,7 +135,7 @@ QString ConnmanCounter::getLabel(const QVariantMap& map)
   short num_m = 0;
   short num_s = 0;
   
-  int etime = map.value("Time").toInt();
+  int etime = static_cast<int>(data.time);
   num_d = etime / (24 * 60 * 60);
   if (num_d > 0 ) {
     rtn.append(tr("%n Day(s)", 0, num_d) );
@@ -134,6 +164,45 @@ QString ConnmanCounter::getLabel(const QVariantMap& map)
   return rtn;
 }
 
+//
+//  Function to return a byte count as Bytes, KB, MB, or GB depending on size
+QString ConnmanCounter::bytesText(quint64 bytes)
+{
+  const quint64 b_cutoff = 1024 * 1.875       ; // size in Bytes to change units from Bytes to KB
+  const quint64 k_cutoff = 1024 * 1024 * 1.875 ; // size in Bytes to change units from KB to MB
+  const quint64 m_cutoff = 1024 * 1024 * 1024 * 1.875 ; // size in Bytes to change units from MB to GB
+
+  if (bytes < b_cutoff ) return tr("%L1 Bytes").arg(bytes);
+  if (bytes < k_cutoff) return tr("%L1 KB").arg(static_cast<double>(bytes) / (1024), 0, 'f', 1);
+  if (bytes < m_cutoff) return tr("%L1 MB").arg(static_cast<double>(bytes) / (1024 * 1024), 0, 'f', 1);
+
+  return tr("%L1 GB").arg(static_cast<double>(bytes) / (1024 * 1024 * 1024), 0, 'f', 1);
+}
+
+//
+//  Function to return the counters of all services added together
+CounterEntry ConnmanCounter::total() const
+{
+  CounterEntry rtn;
+  QHash<QString,CounterEntry>::const_iterator i = counters.constBegin();
+  while (i != counters.constEnd()) {
+    rtn.home += i.value().home;
+    rtn.roam += i.value().roam;
+    ++i;
+  } // while
+
+  return rtn;
+}
+
+//
+//  Function to return the rate history of a service, null if there is none
+const RateHistory* ConnmanCounter::rates(const QString& path) const
+{
+  QHash<QString,RateHistory>::const_iterator i = histories.constFind(path);
+
+  return i == histories.constEnd() ? 0 : &i.value();
+}
+
 /////////////////////////////////////// PUBLIC Q_SLOTS////////////////////////////////
 //
 // Called when the service daemon unregisters the counter.  QT deals with cleanup
@@ -150,23 +219,25 @@ void ConnmanCounter::Release()
 void ConnmanCounter::Usage(QDBusObjectPath qdb_objpath, QVariantMap home, QVariantMap roaming)
 {
   // First time through connman will send home and roaming fully loaded.  After that only
-  // items that change are sent.  We need to keep the data as a class member
-  QMapIterator<QString, QVariant> i(home);
-  while (i.hasNext()) {
-    i.next();
-    home_data[i.key()] = i.value();
-    }
-    
-  QMapIterator<QString, QVariant> j(roaming);
-  while (j.hasNext()) {
-    j.next();
-    roam_data[j.key()] = j.value();
-    }    
-  
-  // Emit signal with object and labels to display
-  emit usageUpdated(qdb_objpath, getLabel(home_data), getLabel(roam_data) );
+  // items that change are sent.  Keep the data per service so that services online at
+  // the same time don't mix.
+  const bool b_new = ! counters.contains(qdb_objpath.path() );
+  CounterEntry& entry = counters[qdb_objpath.path()];
+  entry.home.merge(home);
+  entry.roam.merge(roaming);
+
+  // Turn the new totals into rates, for the service and for all of them.  A new
+  // service brings its whole total with it, that is not a rate for the sum.
+  const qint64 now = clock.elapsed();
+  histories[qdb_objpath.path()].addSample(now, entry.home.rx_bytes + entry.roam.rx_bytes, entry.home.tx_bytes + entry.roam.tx_bytes);
+  const CounterEntry sum = this->total();
+  if (b_new)
+    total_rates.setBase(now, sum.home.rx_bytes + sum.roam.rx_bytes, sum.home.tx_bytes + sum.roam.tx_bytes);
+  else
+    total_rates.addSample(now, sum.home.rx_bytes + sum.roam.rx_bytes, sum.home.tx_bytes + sum.roam.tx_bytes);
+
+  // Emit signal with the object, the labels are built by whoever displays them
+  emit usageUpdated(qdb_objpath);
 
   return;
 }
-
-
@@ -33,12 +33,44 @@ DEALINGS IN THE SOFTWARE.
 # include <QObject>
 # include <QString>
 # include <QVariantMap>
+# include <QHash>
+# include <QElapsedTimer>
 # include <QtDBus/QDBusObjectPath>
 
+# include "./code/rategraph/ratehistory.h"
+
 # define CNTR_SERVICE "org.cmst"
 # define CNTR_INTERFACE "net.connman.Counter"
 # define CNTR_OBJECT "/org/cmst/Counter"
 
+//
+// Counter values for one direction of one service.  Connman sends every
+// field the first time and after that only the ones that changed.
+struct CounterData
+{
+	quint64 rx_packets;
+	quint64 rx_bytes;
+	quint64 rx_errors;
+	quint64 rx_dropped;
+	quint64 tx_packets;
+	quint64 tx_bytes;
+	quint64 tx_errors;
+	quint64 tx_dropped;
+	quint64 time;
+
+	CounterData() : rx_packets(0), rx_bytes(0), rx_errors(0), rx_dropped(0),
+		tx_packets(0), tx_bytes(0), tx_errors(0), tx_dropped(0), time(0) {}
+	void merge(const QVariantMap&);
+	CounterData& operator+=(const CounterData&);
+};
+
+//
+// Home and roaming counters of a service
+struct CounterEntry
+{
+	CounterData home;
+	CounterData roam;
+};
 
 class ConnmanCounter : public QObject
 {
@@ -47,19 +79,27 @@ class ConnmanCounter : public QObject
  
     public:
 			ConnmanCounter(QObject*);
-			QString getLabel(const QVariantMap&);
-			inline int cnxns() {return receivers(SIGNAL(usageUpdated(const QDBusObjectPath&, const QString&, const QString&)));}
+			QString getLabel(const CounterData&);
+			static QString bytesText(quint64);
+			CounterEntry total() const;
+			inline const QHash<QString,CounterEntry>& entries() const {return counters;}
+			inline void remove(const QString& path) {counters.remove(path); histories.remove(path);}
+			const RateHistory* rates(const QString&) const;
+			inline const RateHistory* totalRates() const {return &total_rates;}
+			inline int cnxns() {return receivers(SIGNAL(usageUpdated(const QDBusObjectPath&)));}
 							
 		signals:
-			void usageUpdated(const QDBusObjectPath&, const QString&, const QString&);	
+			void usageUpdated(const QDBusObjectPath&);	
  
     public Q_SLOTS:
       void Release();
 			void Usage(QDBusObjectPath, QVariantMap, QVariantMap);
      
     private:
-			QVariantMap home_data;
-			QVariantMap roam_data;
+			QHash<QString,CounterEntry> counters;
+			QHash<QString,RateHistory> histories;
+			RateHistory total_rates;
+			QElapsedTimer clock;
 };    
 
 #endif
@@ -0,0 +1,165 @@
+/**************************** killswitch.cpp ***************************
+
+VPN internet kill switch.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <syslog.h>
+
+# include "./killswitch.h"
+# include "../resource.h"
+# include "./code/shared/shared.h"
+# include "technology_interface.h"
+
+// number of engagement latencies we keep
+# define LATENCY_HISTORY 16
+
+// constructor
+KillSwitch::KillSwitch(const ConnmanStore* cs, ProxyCache* pc, QObject* parent) : QObject(parent)
+{
+   store = cs;
+   proxies = pc;
+   b_enabled = false;
+   vpnpath.clear();
+   vpnname.clear();
+   calls.clear();
+   latency_list.clear();
+}
+
+//
+// Function to note which VPN service, if any, is at the top of the
+// services list.  Never engages the switch.
+void KillSwitch::sync()
+{
+   vpnpath.clear();
+   vpnname.clear();
+   if (store->services().count() > 0 && store->services().at(0).type == ServiceRecord::Type_VPN) {
+      vpnpath = store->services().at(0).objpath.path();
+      vpnname = store->services().at(0).name;
+   } // if vpn on top
+
+   return;
+}
+
+//
+// Function called as soon as a ServicesChanged signal has been merged into
+// the store.  Engage the switch if a VPN was on top and is not anymore.
+// A VPN replacing another VPN is fine.  b_userinitiated is true if the
+// user asked for the change.
+void KillSwitch::servicesChanged(bool b_userinitiated)
+{
+   if (b_enabled && ! b_userinitiated && ! vpnpath.isEmpty() ) {
+      if (store->services().count() == 0 || store->services().at(0).type != ServiceRecord::Type_VPN) {
+         clock.start();
+         engage();
+      } // if vpn is not on top any more
+   } // if armed and a vpn was on top
+
+   sync();
+
+   return;
+}
+
+//
+// Function called when the State of a service changed.  Connman usually
+// sends this before it reorders the services list, so check it here too.
+void KillSwitch::serviceStateChanged(const QString& path, ServiceRecord::State state, bool b_userinitiated)
+{
+   if (path != vpnpath) return;
+   if (state != ServiceRecord::State_Idle && state != ServiceRecord::State_Failure && state != ServiceRecord::State_Disconnect) return;
+
+   if (b_enabled && ! b_userinitiated) {
+      clock.start();
+      engage();
+   } // if armed
+
+   // the vpn is gone, the ServicesChanged that follows has nothing to do
+   vpnpath.clear();
+
+   return;
+}
+
+//
+// Slot to arm or disarm the switch
+void KillSwitch::setEnabled(bool enabled)
+{
+   b_enabled = enabled;
+
+   return;
+}
+
+////////////////////////////////////////////// Private Functions //////////////////////////////////
+//
+// Function to power off every powered technology.  All of the calls are
+// sent before any reply is looked at, so the devices go down in parallel.
+void KillSwitch::engage()
+{
+   if (! calls.isEmpty() ) return;   // already engaging
+
+   for (int i = 0; i < store->technologies().count(); ++i) {
+      if (! store->technologies().at(i).powered) continue;
+      const QString path = store->technologies().at(i).objpath.path();
+      QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(proxies->technology(path)->SetProperty("Powered", QDBusVariant(false)), this);
+      calls.insert(watcher, path);
+      connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(powerReplied(QDBusPendingCallWatcher*)));
+   } // for
+
+   emit engaged(vpnname);
+   if (calls.isEmpty() ) finish();
+
+   return;
+}
+
+//
+// Function called when every power off has been answered.  Record how
+// long it took from noticing the VPN was gone.
+void KillSwitch::finish()
+{
+   const qint64 ms = clock.elapsed();
+   latency_list.append(ms);
+   if (latency_list.count() > LATENCY_HISTORY) latency_list.remove(0);
+
+   openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+   syslog(LOG_INFO, "VPN kill switch engaged, devices powered off %lld ms after the VPN dropped", static_cast<long long>(ms) );
+   closelog();
+
+   emit cutoff(ms);
+
+   return;
+}
+
+////////////////////////////////////////////// Private Slots //////////////////////////////////////
+//
+// Slot called when the reply to a power off arrives
+void KillSwitch::powerReplied(QDBusPendingCallWatcher* watcher)
+{
+   calls.remove(watcher);
+   const QDBusMessage reply = watcher->reply();
+   watcher->deleteLater();
+
+   shared::processReply(reply);
+   if (calls.isEmpty() ) finish();
+
+   return;
+}
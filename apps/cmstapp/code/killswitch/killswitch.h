@@ -0,0 +1,81 @@
+/**************************** killswitch.h *****************************
+
+VPN internet kill switch.  Watches the VPN service at the top of the
+services list and powers off every technology the moment it drops.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef KILL_SWITCH_H
+# define KILL_SWITCH_H
+
+# include <QObject>
+# include <QString>
+# include <QHash>
+# include <QVector>
+# include <QElapsedTimer>
+# include <QDBusPendingCallWatcher>
+
+# include "./code/store/store.h"
+# include "./code/proxycache/proxycache.h"
+
+class KillSwitch : public QObject
+{
+   Q_OBJECT
+
+   public:
+      KillSwitch(const ConnmanStore*, ProxyCache*, QObject* parent = 0);
+
+      void sync();
+      void servicesChanged(bool);
+      void serviceStateChanged(const QString&, ServiceRecord::State, bool);
+      inline bool isEnabled() const {return b_enabled;}
+      inline const QVector<qint64>& latencies() const {return latency_list;}
+
+   public slots:
+      void setEnabled(bool);
+
+   signals:
+      void engaged(const QString&);
+      void cutoff(qint64);
+
+   private:
+      // members
+      const ConnmanStore* store;
+      ProxyCache* proxies;
+      bool b_enabled;
+      QString vpnpath;
+      QString vpnname;
+      QHash<QDBusPendingCallWatcher*, QString> calls;
+      QElapsedTimer clock;
+      QVector<qint64> latency_list;
+
+      // functions
+      void engage();
+      void finish();
+
+   private slots:
+      void powerReplied(QDBusPendingCallWatcher*);
+};
+
+# endif
@@ -147,6 +147,24 @@ int main(int argc, char *argv[])
       "10" );
    parser.addOption(counterUpdateRate);
 
+   QCommandLineOption redrawInterval (QStringList() << "redraw-interval",
+      QCoreApplication::translate("main.cpp", "The time in milliseconds to collect changes from connman before the display is redrawn."),
+      QCoreApplication::translate("main.cpp", "milliseconds"),
+      "16" );
+   parser.addOption(redrawInterval);
+
+   QCommandLineOption strengthDelta (QStringList() << "strength-delta",
+      QCoreApplication::translate("main.cpp", "The smallest change in wifi signal strength (percent) that is redrawn. 0 redraws every change."),
+      QCoreApplication::translate("main.cpp", "percent"),
+      "10" );
+   parser.addOption(strengthDelta);
+
+   QCommandLineOption counterRefresh (QStringList() << "counter-refresh",
+      QCoreApplication::translate("main.cpp", "The shortest time in milliseconds between redraws of the counters page."),
+      QCoreApplication::translate("main.cpp", "milliseconds"),
+      "1000" );
+   parser.addOption(counterRefresh);
+
    // Added on 2015.01.04 to work around QT5.4 bug with transparency not always working
    QCommandLineOption fakeTransparency(QStringList() << "fake-transparency",
       QCoreApplication::translate("main.cpp", "If tray icon fake transparency is required, specify the background color to use (format: 0xRRGGBB)"),
@@ -0,0 +1,171 @@
+/**************************** delegate.cpp ***************************
+
+Item delegate for the store models.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QApplication>
+# include <QPainter>
+# include <QMouseEvent>
+# include <QStyle>
+# include <QStyleOptionProgressBar>
+# include <QStyleOptionButton>
+
+# include "./delegate.h"
+# include "./models.h"
+
+// margins around the bars, the same the old cell widgets used
+# define BAR_LEFT 7
+# define BAR_TOP 5
+# define BAR_RIGHT 11
+# define BAR_BOTTOM 5
+
+// margin around the toggle buttons
+# define BUTTON_MARGIN 5
+
+//
+// constructor
+StoreDelegate::StoreDelegate(QObject* parent) : QStyledItemDelegate(parent)
+{
+   highlight = QColor();
+}
+
+//
+// Function to paint a cell.  Text cells are left to the base class.
+void StoreDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+   const int cell = index.data(StoreModel::CellRole).toInt();
+   if (cell == StoreModel::Cell_Text) {
+      QStyledItemDelegate::paint(painter, option, index);
+      return;
+   }
+
+   // draw the background and selection without any text or icon
+   QStyleOptionViewItem opt = option;
+   initStyleOption(&opt, index);
+   opt.text.clear();
+   opt.icon = QIcon();
+   opt.features &= ~(QStyleOptionViewItem::HasDisplay | QStyleOptionViewItem::HasDecoration | QStyleOptionViewItem::HasCheckIndicator);
+   QStyle* style = opt.widget != 0 ? opt.widget->style() : QApplication::style();
+   style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+   switch (cell) {
+      case StoreModel::Cell_Pixmap: {
+         QPixmap pxm = index.data(Qt::DecorationRole).value<QPixmap>();
+         if (! pxm.isNull() ) {
+            QSize sz = pxm.size() / pxm.devicePixelRatio();
+            QRect rect = QStyle::alignedRect(option.direction, Qt::AlignCenter, sz, option.rect);
+            painter->drawPixmap(rect, pxm);
+         }
+         break; }
+
+      case StoreModel::Cell_Strength:
+      case StoreModel::Cell_Busy: {
+         QStyleOptionProgressBar pbo;
+         pbo.initFrom(opt.widget);
+         pbo.rect = barRect(option.rect);
+         pbo.minimum = 0;
+         pbo.maximum = cell == StoreModel::Cell_Strength ? 100 : 0;
+         pbo.progress = cell == StoreModel::Cell_Strength ? index.data(Qt::DisplayRole).toInt() : 0;
+         pbo.text = cell == StoreModel::Cell_Strength ? QString("%1%").arg(pbo.progress) : index.data(Qt::DisplayRole).toString();
+         pbo.textVisible = true;
+         pbo.textAlignment = Qt::AlignCenter;
+         pbo.state |= QStyle::State_Horizontal;
+         if (highlight.isValid() ) pbo.palette.setColor(QPalette::Active, QPalette::Highlight, highlight);
+         style->drawControl(QStyle::CE_ProgressBar, &pbo, painter, opt.widget);
+         break; }
+
+      case StoreModel::Cell_Toggle: {
+         QStyleOptionButton bo;
+         bo.initFrom(opt.widget);
+         bo.rect = option.rect.adjusted(BUTTON_MARGIN, 1, -BUTTON_MARGIN, -1);
+         bo.text = index.data(Qt::DisplayRole).toString();
+         QPixmap pxm = index.data(Qt::DecorationRole).value<QPixmap>();
+         if (! pxm.isNull() ) {
+            bo.icon = QIcon(pxm);
+            bo.iconSize = option.decorationSize;
+         }
+         bo.state &= ~(QStyle::State_Enabled | QStyle::State_On | QStyle::State_Off);
+         if (index.flags() & Qt::ItemIsEnabled) bo.state |= QStyle::State_Enabled;
+         bo.state |= index.data(Qt::CheckStateRole).toInt() == Qt::Checked ? QStyle::State_On : QStyle::State_Off;
+         style->drawControl(QStyle::CE_PushButton, &bo, painter, opt.widget);
+         break; }
+
+      default:
+         break;
+   } // switch
+
+   return;
+}
+
+//
+// Function to return the size of a cell
+QSize StoreDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+   QSize sz = QStyledItemDelegate::sizeHint(option, index);
+
+   switch (index.data(StoreModel::CellRole).toInt()) {
+      case StoreModel::Cell_Strength:
+      case StoreModel::Cell_Busy:
+         sz.rheight() += BAR_TOP + BAR_BOTTOM;
+         sz.rwidth() += BAR_LEFT + BAR_RIGHT;
+         break;
+      case StoreModel::Cell_Toggle:
+         sz.rwidth() += 4 * BUTTON_MARGIN;
+         break;
+      default:
+         break;
+   } // switch
+
+   return sz;
+}
+
+//
+// Function to handle mouse clicks.  A click on an enabled toggle button
+// emits toggled() with the object path and the new state.  The model is
+// not changed here, connman will send a PropertyChanged signal when the
+// change takes effect.
+bool StoreDelegate::editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index)
+{
+   if (index.data(StoreModel::CellRole).toInt() != StoreModel::Cell_Toggle)
+      return QStyledItemDelegate::editorEvent(event, model, option, index);
+
+   if (event->type() != QEvent::MouseButtonRelease) return false;
+   if (! (index.flags() & Qt::ItemIsEnabled) ) return false;
+
+   QMouseEvent* me = static_cast<QMouseEvent*>(event);
+   if (me->button() != Qt::LeftButton) return false;
+   if (! option.rect.adjusted(BUTTON_MARGIN, 1, -BUTTON_MARGIN, -1).contains(me->pos()) ) return false;
+
+   emit toggled(index.data(StoreModel::PathRole).toString(), index.data(Qt::CheckStateRole).toInt() != Qt::Checked);
+
+   return true;
+}
+
+//
+// Function to return the rectangle a progress bar is drawn in
+QRect StoreDelegate::barRect(const QRect& cell) const
+{
+   return cell.adjusted(BAR_LEFT, BAR_TOP, -BAR_RIGHT, -BAR_BOTTOM);
+}
@@ -0,0 +1,61 @@
+/**************************** delegate.h *****************************
+
+Item delegate for the store models.  Draws signal strength bars, busy
+bars, centered pixmaps and toggle buttons directly with the style so
+the tables don't need a widget in every cell.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef STORE_DELEGATE_H
+# define STORE_DELEGATE_H
+
+# include <QStyledItemDelegate>
+# include <QColor>
+
+class StoreDelegate : public QStyledItemDelegate
+{
+   Q_OBJECT
+
+   public:
+      StoreDelegate(QObject* parent = 0);
+
+      void paint(QPainter*, const QStyleOptionViewItem&, const QModelIndex&) const;
+      QSize sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const;
+      inline void setHighlight(const QColor& col) {highlight = col;}
+
+   protected:
+      bool editorEvent(QEvent*, QAbstractItemModel*, const QStyleOptionViewItem&, const QModelIndex&);
+
+   private:
+      // members
+      QColor highlight;
+
+      // functions
+      QRect barRect(const QRect&) const;
+
+   signals:
+      void toggled(QString, bool);
+};
+
+# endif
@@ -0,0 +1,597 @@
+/**************************** models.cpp *****************************
+
+Table models for the technologies, services, wifi and vpn views.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QFileInfo>
+
+# include "./models.h"
+# include "./code/trstring/tr_strings.h"
+
+// above this many row moves refresh() uses a layout change instead
+# define MAX_MOVES 8
+
+////////////////////////////////////////////////// StoreModel ////////////////////////////////////////
+//
+// constructor
+StoreModel::StoreModel(const ConnmanStore* st, IconManager* im, QObject* parent) : QAbstractTableModel(parent)
+{
+   store = st;
+   iconman = im;
+   iconscale = 1.0;
+   headers.clear();
+   paths.clear();
+   signatures.clear();
+   rows.clear();
+   pixmaps.clear();
+   b_tracked = false;
+   b_all = true;
+   b_reordered = false;
+   dirty.clear();
+}
+
+int StoreModel::rowCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : paths.size();
+}
+
+int StoreModel::columnCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : headers.size();
+}
+
+QVariant StoreModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+   if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < headers.size() )
+      return headers.at(section);
+
+   return QVariant();
+}
+
+QVariant StoreModel::data(const QModelIndex& index, int role) const
+{
+   if (! index.isValid() || index.row() >= paths.size() ) return QVariant();
+
+   if (role == PathRole) return paths.at(index.row());
+
+   return cellData(paths.at(index.row()), index.column(), role);
+}
+
+Qt::ItemFlags StoreModel::flags(const QModelIndex& index) const
+{
+   if (! index.isValid() || index.row() >= paths.size() ) return Qt::NoItemFlags;
+
+   Qt::ItemFlags fl = Qt::ItemIsSelectable;
+   if (cellEnabled(paths.at(index.row()), index.column()) ) fl |= Qt::ItemIsEnabled;
+
+   return fl;
+}
+
+//
+// Function to note what a merge or a property change did to the store.
+// Only used when the model tracks changes, refresh() then recomputes the
+// signatures of the reported rows only.
+void StoreModel::addChanges(const ChangeSet& changes)
+{
+   for (int i = 0; i < changes.changed.size(); ++i) {
+      dirty.insert(changes.changed.at(i) );
+   } // for
+   for (int i = 0; i < changes.inserted.size(); ++i) {
+      dirty.insert(changes.inserted.at(i) );
+   } // for
+   for (int i = 0; i < changes.moved.size(); ++i) {
+      dirty.insert(changes.moved.at(i).path );
+   } // for
+   if (changes.isReordered() ) b_reordered = true;
+
+   return;
+}
+
+//
+// Function to make the next refresh() compare every row, for instance
+// after the store list was replaced without a change set
+void StoreModel::changeAll()
+{
+   b_all = true;
+
+   return;
+}
+
+//
+// Slot to bring the model up to date with the store.  The rows the view
+// has are reconciled with the store by object path: rows that are gone
+// are removed, new rows are inserted, rows that moved are moved, and rows
+// whose signature changed are reported with dataChanged.  Views only
+// repaint what changed and persistent indexes (the selection and current
+// index) stay with their object.  If a reorder needs more than MAX_MOVES
+// single row moves the rows are rearranged with one layout change instead.
+//
+// If the model tracks changes only the rows reported with addChanges()
+// get a new signature, and if nothing was inserted, removed or moved the
+// row order is not looked at at all.
+void StoreModel::refresh()
+{
+   const bool b_every = ! b_tracked || b_all;
+   const bool b_order = b_every || b_reordered;
+   const QSet<QString> reported = dirty;
+   b_all = false;
+   b_reordered = false;
+   dirty.clear();
+
+   // only properties changed, update the reported rows
+   if (! b_order) {
+      QSetIterator<QString> itr(reported);
+      while (itr.hasNext()) {
+         const QString& path = itr.next();
+         const int row = rows.value(path, -1);
+         if (row < 0) continue;
+         const QString sig = signature(path);
+         if (sig != signatures.at(row) ) {
+            signatures[row] = sig;
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1) );
+         } // if
+      } // while
+      return;
+   } // if no reorder
+
+   const int count = storeCount();
+   QVector<QString> newpaths;
+   QVector<QString> newsignatures;
+   QHash<QString,int> newrows;
+   newpaths.reserve(count);
+   newsignatures.reserve(count);
+   newrows.reserve(count);
+   for (int row = 0; row < count; ++row) {
+      const QString path = storePath(row);
+      // reuse the signatures of rows not reported
+      const int oldrow = b_every ? -1 : rows.value(path, -1);
+      newpaths.append(path);
+      newsignatures.append(oldrow < 0 || reported.contains(path) ? signature(path) : signatures.at(oldrow) );
+      newrows.insert(path, row);
+   } // for
+
+   // same rows, send dataChanged for the ones that changed
+   if (newpaths == paths) {
+      for (int row = 0; row < count; ++row) {
+         if (newsignatures.at(row) != signatures.at(row) ) {
+            signatures[row] = newsignatures.at(row);
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1) );
+         } // if
+      } // for
+      return;
+   } // if same rows
+
+   // remove rows that are gone, from the bottom up so the rows we still
+   // have to look at don't shift.  Adjacent rows go in one block.
+   bool b_removed = false;
+   for (int last = paths.size() - 1; last >= 0; --last) {
+      if (newrows.contains(paths.at(last)) ) continue;
+      int first = last;
+      while (first > 0 && ! newrows.contains(paths.at(first - 1)) ) --first;
+      beginRemoveRows(QModelIndex(), first, last);
+      paths.remove(first, last - first + 1);
+      signatures.remove(first, last - first + 1);
+      endRemoveRows();
+      b_removed = true;
+      last = first;
+   } // for
+   if (b_removed) reindex();
+
+   // the rows left are all in the new list.  Count the moves needed to put
+   // them in the new order, stop counting once there are too many.
+   if (countMoves(newpaths) > MAX_MOVES) {
+      relayout(newpaths, newsignatures, newrows);
+      return;
+   }
+
+   // Walk the new list putting each row in place.  rows is left as it was
+   // after the removals.  A row not placed yet has moved down once for
+   // every row inserted above it and once for every row moved up from
+   // below it, which is all the walk needs to find it.
+   int inserts = 0;
+   QVector<int> movedfrom;
+   for (int row = 0; row < count; ++row) {
+      const QString& path = newpaths.at(row);
+
+      // already in place
+      if (row < paths.size() && paths.at(row) == path) {
+         if (signatures.at(row) != newsignatures.at(row) ) {
+            signatures[row] = newsignatures.at(row);
+            emit dataChanged(index(row, 0), index(row, columnCount() - 1) );
+         } // if
+         continue;
+      } // if
+
+      // a new row
+      const int oldrow = rows.value(path, -1);
+      if (oldrow < 0) {
+         beginInsertRows(QModelIndex(), row, row);
+         paths.insert(row, path);
+         signatures.insert(row, newsignatures.at(row) );
+         endInsertRows();
+         ++inserts;
+         continue;
+      } // if
+
+      // a row further down that needs to come up to here
+      int from = oldrow + inserts;
+      for (int i = 0; i < movedfrom.size(); ++i) {
+         if (movedfrom.at(i) > oldrow) ++from;
+      } // for
+      movedfrom.append(oldrow);
+      const bool b_changed = signatures.at(from) != newsignatures.at(row);
+      beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+      paths.remove(from);
+      signatures.remove(from);
+      paths.insert(row, path);
+      signatures.insert(row, newsignatures.at(row) );
+      endMoveRows();
+      if (b_changed) emit dataChanged(index(row, 0), index(row, columnCount() - 1) );
+   } // for
+   rows = newrows;
+
+   return;
+}
+
+//
+// Function to rebuild the row lookup from the paths
+void StoreModel::reindex()
+{
+   rows.clear();
+   rows.reserve(paths.size());
+   for (int row = 0; row < paths.size(); ++row) {
+      rows.insert(paths.at(row), row);
+   } // for
+
+   return;
+}
+
+//
+// Function to count how many single row moves the walk in refresh() would
+// make to put the rows we have in the order of newpaths.  Rows we don't
+// have are new and don't count.  Stops counting past MAX_MOVES.
+int StoreModel::countMoves(const QVector<QString>& newpaths) const
+{
+   QVector<QString> order = paths;
+   int moves = 0;
+   int row = 0;
+   for (int i = 0; i < newpaths.size() && moves <= MAX_MOVES; ++i) {
+      if (! rows.contains(newpaths.at(i)) ) continue;
+      if (order.at(row) != newpaths.at(i) ) {
+         order.remove(order.indexOf(newpaths.at(i), row + 1) );
+         order.insert(row, newpaths.at(i) );
+         ++moves;
+      } // if
+      ++row;
+   } // for
+
+   return moves;
+}
+
+//
+// Function to rearrange the rows with a single layout change.  Persistent
+// indexes follow their object path.
+void StoreModel::relayout(const QVector<QString>& newpaths, const QVector<QString>& newsignatures, const QHash<QString,int>& newrows)
+{
+   emit layoutAboutToBeChanged();
+   const QModelIndexList oldlist = persistentIndexList();
+   QVector<int> moveto;
+   moveto.reserve(oldlist.size());
+   for (int i = 0; i < oldlist.size(); ++i) {
+      moveto.append(newrows.value(paths.value(oldlist.at(i).row()), -1) );
+   } // for
+
+   paths = newpaths;
+   signatures = newsignatures;
+   rows = newrows;
+
+   QModelIndexList newlist;
+   for (int i = 0; i < oldlist.size(); ++i) {
+      newlist.append(moveto.at(i) < 0 ? QModelIndex() : createIndex(moveto.at(i), oldlist.at(i).column()) );
+   } // for
+   changePersistentIndexList(oldlist, newlist);
+   emit layoutChanged();
+
+   return;
+}
+
+//
+// Slot to redraw every row, for instance after the icon color changed
+void StoreModel::invalidate()
+{
+   pixmaps.clear();
+   if (paths.size() > 0 && columnCount() > 0)
+      emit dataChanged(index(0, 0), index(paths.size() - 1, columnCount() - 1) );
+
+   return;
+}
+
+//
+// Function to return if a cell is enabled.  Subclasses override this
+// for toggle buttons that can't be pressed.
+bool StoreModel::cellEnabled(const QString& path, int col) const
+{
+   (void) path;
+   (void) col;
+
+   return true;
+}
+
+//
+// Function to return an icon from the icon manager as a pixmap. Pixmaps
+// are cached until the model is invalidated.
+QPixmap StoreModel::pixmap(const QString& name) const
+{
+   QHash<QString,QPixmap>::const_iterator itr = pixmaps.constFind(name);
+   if (itr != pixmaps.constEnd() ) return itr.value();
+
+   QPixmap pxm = iconman->getIcon(name).pixmap(QSize(16,16) *= iconscale);
+   pixmaps.insert(name, pxm);
+
+   return pxm;
+}
+
+////////////////////////////////////////////////// TechnologyModel ///////////////////////////////////
+//
+// constructor
+TechnologyModel::TechnologyModel(const ConnmanStore* st, IconManager* im, QObject* parent) : StoreModel(st, im, parent)
+{
+}
+
+QString TechnologyModel::signature(const QString& path) const
+{
+   const TechnologyRecord* rec = store->technologies().find(path);
+   if (rec == NULL) return QString();
+
+   return QString("%1|%2|%3%4%5|%6|%7")
+      .arg(rec->name)
+      .arg(rec->type)
+      .arg(rec->powered)
+      .arg(rec->connected)
+      .arg(rec->tethering)
+      .arg(rec->tetheringidentifier)
+      .arg(rec->tetheringpassphrase);
+}
+
+QVariant TechnologyModel::cellData(const QString& path, int col, int role) const
+{
+   const TechnologyRecord* rec = store->technologies().find(path);
+   if (rec == NULL) return QVariant();
+
+   if (role == Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+
+   switch (col) {
+      case 0:
+         if (role == Qt::DisplayRole) return TranslateStrings::cmtr(rec->name);
+         break;
+      case 1:
+         if (role == Qt::DisplayRole) return TranslateStrings::cmtr(rec->typeString() );
+         break;
+      case 2:
+         if (role == CellRole) return Cell_Toggle;
+         if (role == Qt::CheckStateRole) return rec->powered ? Qt::Checked : Qt::Unchecked;
+         if (role == Qt::DisplayRole) return rec->powered ? QCoreApplication::translate("ControlBox", "On", "powered") : QCoreApplication::translate("ControlBox", "Off", "powered");
+         if (role == Qt::DecorationRole) return QPixmap(rec->powered ? ":/icons/images/interface/golfball_green.png" : ":/icons/images/interface/golfball_red.png");
+         break;
+      case 3:
+         if (role == Qt::DisplayRole) return rec->connected ? QCoreApplication::translate("ControlBox", "Yes", "connected") : QCoreApplication::translate("ControlBox", "No", "connected");
+         break;
+      case 4:
+         if (role == CellRole) return Cell_Toggle;
+         if (role == Qt::CheckStateRole) return rec->tethering ? Qt::Checked : Qt::Unchecked;
+         if (role == Qt::DisplayRole) return rec->tethering ? QCoreApplication::translate("ControlBox", "On", "tethering") : QCoreApplication::translate("ControlBox", "Off", "tethering");
+         if (role == Qt::DecorationRole) return QPixmap(rec->tethering ? ":/icons/images/interface/golfball_green.png" : ":/icons/images/interface/golfball_red.png");
+         break;
+      case 5:
+         if (role == Qt::DisplayRole) {
+            QString sid = rec->tetheringidentifier;
+            QString spw = rec->tetheringpassphrase;
+            if (sid.isEmpty() ) sid = "--";
+            if (spw.isEmpty() ) spw = "--";
+            return QString("%1 : %2").arg(sid).arg(spw);
+         }
+         break;
+      default:
+         break;
+   } // switch
+
+   if (role == CellRole) return Cell_Text;
+
+   return QVariant();
+}
+
+//
+// The tethering button is disabled for wired technologies and for
+// technologies that are not powered
+bool TechnologyModel::cellEnabled(const QString& path, int col) const
+{
+   if (col != 4) return true;
+
+   const TechnologyRecord* rec = store->technologies().find(path);
+   if (rec == NULL) return false;
+   if (rec->tethering) return true;
+
+   return rec->type != ServiceRecord::Type_Ethernet && rec->powered;
+}
+
+////////////////////////////////////////////////// ServiceModel //////////////////////////////////////
+//
+// constructor
+ServiceModel::ServiceModel(const ConnmanStore* st, IconManager* im, QObject* parent) : StoreModel(st, im, parent)
+{
+}
+
+QString ServiceModel::signature(const QString& path) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QString();
+
+   return QString("%1|%2|%3").arg(store->nickName(rec->objpath)).arg(rec->type).arg(rec->state);
+}
+
+QVariant ServiceModel::cellData(const QString& path, int col, int role) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QVariant();
+
+   if (role == CellRole) return Cell_Text;
+   if (role == Qt::TextAlignmentRole) return col == 3 ? int(Qt::AlignVCenter | Qt::AlignLeft) : int(Qt::AlignCenter);
+   if (role != Qt::DisplayRole) return QVariant();
+
+   switch (col) {
+      case 0:
+         return TranslateStrings::cmtr(store->nickName(rec->objpath) );
+      case 1:
+         return TranslateStrings::cmtr(rec->typeString() );
+      case 2:
+         return TranslateStrings::cmtr(rec->stateString() );
+      case 3:
+         return QFileInfo(path).baseName();
+      default:
+         break;
+   } // switch
+
+   return QVariant();
+}
+
+////////////////////////////////////////////////// WifiModel /////////////////////////////////////////
+//
+// constructor
+WifiModel::WifiModel(const ConnmanStore* st, IconManager* im, QObject* parent) : StoreModel(st, im, parent)
+{
+}
+
+QString WifiModel::signature(const QString& path) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QString();
+
+   return QString("%1|%2|%3|%4|%5")
+      .arg(store->nickName(rec->objpath))
+      .arg(rec->favorite)
+      .arg(rec->state)
+      .arg(rec->security)
+      .arg(rec->strength);
+}
+
+QVariant WifiModel::cellData(const QString& path, int col, int role) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QVariant();
+
+   if (role == Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+
+   switch (col) {
+      case 0:
+         if (role == Qt::DisplayRole) return store->nickName(rec->objpath);
+         break;
+      case 1:
+         if (role == CellRole) return Cell_Pixmap;
+         if (role == Qt::DecorationRole && rec->favorite) return pixmap("favorite");
+         break;
+      case 2:
+         if (role == CellRole) return Cell_Pixmap;
+         if (role == Qt::ToolTipRole) return TranslateStrings::cmtr(rec->stateString() );
+         if (role == Qt::DecorationRole) {
+            if (rec->state == ServiceRecord::State_Online) return pixmap("state_online");
+            if (rec->state == ServiceRecord::State_Ready) return pixmap("state_ready");
+            return pixmap("wifi_tab_state_not_ready");
+         }
+         break;
+      case 3:
+         if (role == Qt::DisplayRole) return TranslateStrings::cmtr_sl(rec->securityStrings()).join(',');
+         break;
+      case 4:
+         if (role == CellRole) return Cell_Strength;
+         if (role == Qt::DisplayRole) return qMax<int>(0, rec->strength);
+         break;
+      default:
+         break;
+   } // switch
+
+   if (role == CellRole) return Cell_Text;
+
+   return QVariant();
+}
+
+////////////////////////////////////////////////// VPNModel //////////////////////////////////////////
+//
+// constructor
+VPNModel::VPNModel(const ConnmanStore* st, IconManager* im, QObject* parent) : StoreModel(st, im, parent)
+{
+}
+
+QString VPNModel::signature(const QString& path) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QString();
+
+   return QString("%1|%2|%3|%4")
+      .arg(store->nickName(rec->objpath))
+      .arg(rec->provider.value("Type").toString())
+      .arg(rec->state)
+      .arg(rec->provider.value("Host").toString());
+}
+
+QVariant VPNModel::cellData(const QString& path, int col, int role) const
+{
+   const ServiceRecord* rec = store->services().find(path);
+   if (rec == NULL) return QVariant();
+
+   if (role == Qt::TextAlignmentRole) return int(Qt::AlignCenter);
+
+   switch (col) {
+      case 0:
+         if (role == Qt::DisplayRole) return store->nickName(rec->objpath);
+         break;
+      case 1:
+         if (role == Qt::DisplayRole) return TranslateStrings::cmtr(rec->provider.value("Type").toString() );
+         break;
+      case 2:
+         if (rec->state == ServiceRecord::State_Association) {
+            if (role == CellRole) return Cell_Busy;
+            if (role == Qt::DisplayRole) return QString("Connecting");
+         }
+         else {
+            if (role == CellRole) return Cell_Pixmap;
+            if (role == Qt::ToolTipRole) return TranslateStrings::cmtr(rec->stateString() );
+            if (role == Qt::DecorationRole) return pixmap(rec->state == ServiceRecord::State_Ready ? "state_vpn_connected" : "state_not_ready");
+         }
+         break;
+      case 3:
+         if (role == Qt::DisplayRole) return rec->provider.value("Host").toString();
+         break;
+      case 4:
+         if (role == Qt::DisplayRole) return QFileInfo(path).baseName();
+         break;
+      default:
+         break;
+   } // switch
+
+   if (role == CellRole) return Cell_Text;
+
+   return QVariant();
+}
@@ -0,0 +1,183 @@
+/**************************** models.h *******************************
+
+Table models for the technologies, services, wifi and vpn views.  The
+models read their data from the ConnmanStore, nothing is copied except
+a signature of each row so we can tell which rows changed.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef STORE_MODELS_H
+# define STORE_MODELS_H
+
+# include <QAbstractTableModel>
+# include <QStringList>
+# include <QVector>
+# include <QHash>
+# include <QSet>
+# include <QPixmap>
+
+# include "./code/store/store.h"
+# include "./code/iconman/iconman.h"
+
+//
+// Base class for the models.  Subclasses say how many rows the store has
+// for them, which object path is on a row, and what a row displays.
+class StoreModel : public QAbstractTableModel
+{
+   Q_OBJECT
+
+   public:
+      // extra data roles, read by the StoreDelegate
+      enum {
+         CellRole = Qt::UserRole + 1,  // what the delegate should draw
+         PathRole,                     // object path of the row
+      };
+
+      // what a cell contains
+      enum {
+         Cell_Text     = 0x00,
+         Cell_Pixmap   = 0x01,  // DecorationRole pixmap drawn centered
+         Cell_Strength = 0x02,  // DisplayRole 0-100 drawn as a bar
+         Cell_Busy     = 0x03,  // DisplayRole text drawn in a busy bar
+         Cell_Toggle   = 0x04,  // button, CheckStateRole is the state
+      };
+
+      StoreModel(const ConnmanStore*, IconManager*, QObject* parent = 0);
+
+      int rowCount(const QModelIndex& parent = QModelIndex()) const;
+      int columnCount(const QModelIndex& parent = QModelIndex()) const;
+      QVariant headerData(int, Qt::Orientation, int role = Qt::DisplayRole) const;
+      QVariant data(const QModelIndex&, int role = Qt::DisplayRole) const;
+      Qt::ItemFlags flags(const QModelIndex&) const;
+
+      inline QString pathAt(int row) const {return (row >= 0 && row < paths.size()) ? paths.at(row) : QString();}
+      inline int rowOf(const QString& path) const {return rows.value(path, -1);}
+      inline void setHeaders(const QStringList& sl) {headers = sl;}
+      inline void setIconScale(float sc) {iconscale = sc;}
+      inline void trackChanges(bool b) {b_tracked = b;}
+      void addChanges(const ChangeSet&);
+      void changeAll();
+
+   public slots:
+      void refresh();
+      void invalidate();
+
+   protected:
+      // members
+      const ConnmanStore* store;
+      QStringList headers;
+
+      // functions
+      virtual int storeCount() const = 0;
+      virtual QString storePath(int) const = 0;
+      virtual QString signature(const QString&) const = 0;
+      virtual QVariant cellData(const QString&, int, int) const = 0;
+      virtual bool cellEnabled(const QString&, int) const;
+      QPixmap pixmap(const QString&) const;
+
+   private:
+      // members
+      IconManager* iconman;
+      float iconscale;
+      QVector<QString> paths;
+      QVector<QString> signatures;
+      QHash<QString,int> rows;
+      mutable QHash<QString,QPixmap> pixmaps;
+      bool b_tracked;
+      bool b_all;
+      bool b_reordered;
+      QSet<QString> dirty;
+
+      // functions
+      void reindex();
+      int countMoves(const QVector<QString>&) const;
+      void relayout(const QVector<QString>&, const QVector<QString>&, const QHash<QString,int>&);
+};
+
+//
+// Technologies shown on the status page
+class TechnologyModel : public StoreModel
+{
+   Q_OBJECT
+
+   public:
+      TechnologyModel(const ConnmanStore*, IconManager*, QObject* parent = 0);
+
+   protected:
+      inline int storeCount() const {return store->technologies().size();}
+      inline QString storePath(int row) const {return store->technologies().at(row).objpath.path();}
+      QString signature(const QString&) const;
+      QVariant cellData(const QString&, int, int) const;
+      bool cellEnabled(const QString&, int) const;
+};
+
+//
+// All services, shown on the status page
+class ServiceModel : public StoreModel
+{
+   Q_OBJECT
+
+   public:
+      ServiceModel(const ConnmanStore*, IconManager*, QObject* parent = 0);
+
+   protected:
+      inline int storeCount() const {return store->services().size();}
+      inline QString storePath(int row) const {return store->services().at(row).objpath.path();}
+      QString signature(const QString&) const;
+      QVariant cellData(const QString&, int, int) const;
+};
+
+//
+// Wifi services, shown on the wireless page
+class WifiModel : public StoreModel
+{
+   Q_OBJECT
+
+   public:
+      WifiModel(const ConnmanStore*, IconManager*, QObject* parent = 0);
+
+   protected:
+      inline int storeCount() const {return store->wifiCount();}
+      inline QString storePath(int row) const {return store->wifiAt(row).objpath.path();}
+      QString signature(const QString&) const;
+      QVariant cellData(const QString&, int, int) const;
+};
+
+//
+// VPN services, shown on the vpn page
+class VPNModel : public StoreModel
+{
+   Q_OBJECT
+
+   public:
+      VPNModel(const ConnmanStore*, IconManager*, QObject* parent = 0);
+
+   protected:
+      inline int storeCount() const {return store->vpnCount();}
+      inline QString storePath(int row) const {return store->vpnAt(row).objpath.path();}
+      QString signature(const QString&) const;
+      QVariant cellData(const QString&, int, int) const;
+};
+
+# endif
@@ -31,20 +31,21 @@ DEALINGS IN THE SOFTWARE.
 
 # include "./peditor.h"
 # include "./code/shared/shared.h"
+# include "service_interface.h"
 # include "./code/trstring/tr_strings.h"
 # include "../resource.h"
 
 #define DBUS_SERVICE "net.connman"
 
-PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae)
+PropertiesEditor::PropertiesEditor(QWidget* parent, const ServiceRecord& rec)
    : QDialog(parent)
 {
    // Setup the user interface
    ui.setupUi(this);
 
    // Data members
-   objpath = ae.objpath;
-   objmap = ae.objmap;
+   objpath = rec.objpath;
+   objmap = rec.toMap();
    sl_ipv4_method << "dhcp" << "manual" << "off";
    sl_ipv6_method << "auto" << "manual" << "off";
    sl_ipv6_privacy << "disabled" << "enabled" << "prefered";            // misspelling prefered is necessary
@@ -84,13 +85,10 @@ PropertiesEditor::PropertiesEditor(QWidget* parent, const arrayElement& ae)
    qrex_val6->deleteLater();
    qrex_val46->deleteLater();
 
-   // initialize and populate submaps
-   ipv4map.clear();
-   ipv6map.clear();
-   proxmap.clear();
-   shared::extractMapData(ipv4map, objmap.value("IPv4.Configuration") );
-   shared::extractMapData(ipv6map, objmap.value("IPv6.Configuration") );
-   shared::extractMapData(proxmap, objmap.value("Proxy.Configuration") );
+   // populate submaps, the record has already decoded them
+   ipv4map = rec.ipv4config;
+   ipv6map = rec.ipv6config;
+   proxmap = rec.proxyconfig;
 
    // Seed initial values in the dialog.
    ui.checkBox_autoconnect->setChecked(objmap.value("AutoConnect").toBool() );
@@ -222,19 +220,15 @@ void PropertiesEditor::updateConfiguration()
    // Some variables
    QString s;
    QStringList sl;
-   QList<QVariant> vlist;
    QMap<QString,QVariant> dict;
-   QDBusInterface* iface_serv = new QDBusInterface(DBUS_SERVICE, objpath.path(), "net.connman.Service", QDBusConnection::systemBus(), this);
+   NetConnmanServiceInterface iface_serv(DBUS_SERVICE, objpath.path(), QDBusConnection::systemBus());
    QList<QLineEdit*> lep;
    QStringList slp;
 
    // QCheckboxes
    // Only update if changed
    if (ui.checkBox_autoconnect->isChecked() != objmap.value("AutoConnect").toBool() ) {
-      vlist.clear();
-      vlist << "AutoConnect";
-      vlist << QVariant::fromValue(QDBusVariant(ui.checkBox_autoconnect->isChecked()) );
-      shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+      shared::processReply(iface_serv.SetProperty("AutoConnect", QDBusVariant(ui.checkBox_autoconnect->isChecked())) );
    }
 
    // QLineEdits (nameservers, timeservers and domains)
@@ -254,10 +248,7 @@ void PropertiesEditor::updateConfiguration()
 
       // Only update if an entry has changed.
       if (sl != objmap.value(slp.at(i)).toStringList()) {
-         vlist.clear();
-         vlist << slp.at(i);
-         vlist << QVariant::fromValue(QDBusVariant(sl) );
-         shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+         shared::processReply(iface_serv.SetProperty(slp.at(i), QDBusVariant(sl)) );
       } // if
    } //for
 
@@ -269,13 +260,11 @@ void PropertiesEditor::updateConfiguration()
          (ui.lineEdit_ipv4netmask->text() != TranslateStrings::cmtr(ipv4map.value("Netmask").toString()) )        |
          (ui.lineEdit_ipv4gateway->text() != TranslateStrings::cmtr(ipv4map.value("Gateway").toString())) ) {
 
-         vlist.clear();
          lep.clear();
          slp.clear();
          dict.clear();
 
          if (ui.comboBox_ipv4method->currentIndex() >= 0) {
-            vlist << "IPv4.Configuration";
             dict.insert("Method", sl_ipv4_method.at(ui.comboBox_ipv4method->currentIndex()) );
             lep << ui.lineEdit_ipv4address << ui.lineEdit_ipv4netmask << ui.lineEdit_ipv4gateway;
             slp << "Address" << "Netmask" << "Gateway";
@@ -287,8 +276,7 @@ void PropertiesEditor::updateConfiguration()
                dict.insert(slp.at(i), s);
             } // for
 
-            vlist << QVariant::fromValue(QDBusVariant(dict) );
-            shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+            shared::processReply(iface_serv.SetProperty("IPv4.Configuration", QDBusVariant(dict)) );
          } // if there is a valid index
       } // if ipv4 changed
    }// ipv4 page is enabled
@@ -302,13 +290,11 @@ void PropertiesEditor::updateConfiguration()
          (ui.lineEdit_ipv6address->text() != TranslateStrings::cmtr(ipv6map.value("Address").toString()) )        |
          (ui.comboBox_ipv6privacy->currentText() != TranslateStrings::cmtr(ipv6map.value("Privacy").toString())) ) {
 
-         vlist.clear();
          lep.clear();
          slp.clear();
          dict.clear();
 
          if (ui.comboBox_ipv6method->currentIndex() >= 0) {
-            vlist << "IPv6.Configuration";
             dict.insert("Method", sl_ipv6_method.at(ui.comboBox_ipv6method->currentIndex()) );
             dict.insert("PrefixLength", QVariant::fromValue(static_cast<quint8>(ui.spinBox_ipv6prefixlength->value())) );
             dict.insert("Privacy", sl_ipv6_privacy.at(ui.comboBox_ipv6privacy->currentIndex()) );
@@ -322,8 +308,7 @@ void PropertiesEditor::updateConfiguration()
                dict.insert(slp.at(i), s);
             } // for
 
-            vlist << QVariant::fromValue(QDBusVariant(dict) );
-            shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+            shared::processReply(iface_serv.SetProperty("IPv6.Configuration", QDBusVariant(dict)) );
          } // if there is a valid index
       } // if ipv6 changed
    } // if ipv6 enabled
@@ -335,11 +320,9 @@ void PropertiesEditor::updateConfiguration()
       (ui.lineEdit_proxyexcludes->text() != proxmap.value("Excludes").toStringList().join("\n") )              |
       (ui.lineEdit_proxyurl->text() != proxmap.value("URL").toString()) ) {
 
-      vlist.clear();
       lep.clear();
       slp.clear();
       dict.clear();
-      vlist << "Proxy.Configuration";
       dict.insert("Method", sl_proxy_method.at(ui.comboBox_proxymethod->currentIndex()) );
 
       lep << ui.lineEdit_proxyurl << ui.lineEdit_proxyservers << ui.lineEdit_proxyexcludes;
@@ -360,20 +343,14 @@ void PropertiesEditor::updateConfiguration()
          } //else
       } // for
 
-      vlist << QVariant::fromValue(QDBusVariant(dict) );
-      shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+      shared::processReply(iface_serv.SetProperty("Proxy.Configuration", QDBusVariant(dict)) );
    } // if proxy changed
 
    // mDNS
    if (ui.checkBox_mdns->isChecked() != objmap.value("mDNS").toBool() ) {
-      vlist.clear();
-      vlist << "mDNS";
-      vlist << QVariant::fromValue(QDBusVariant(ui.checkBox_mdns->isChecked()) );
-      shared::processReply(iface_serv->callWithArgumentList(QDBus::AutoDetect, "SetProperty", vlist) );
+      shared::processReply(iface_serv.SetProperty("mDNS", QDBusVariant(ui.checkBox_mdns->isChecked())) );
    }
 
-   // cleanup
-   iface_serv->deleteLater();
    this->accept();
 }
 
@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 
 # include "ui_peditor.h"
 # include "./code/control_box/controlbox.h"
+# include "./code/store/records.h"
 
 // The class to control the properties editor UI based on a QDialog
 class PropertiesEditor : public QDialog
@@ -45,7 +46,7 @@ class PropertiesEditor : public QDialog
 
    public:
    // members
-      PropertiesEditor(QWidget*, const arrayElement&);
+      PropertiesEditor(QWidget*, const ServiceRecord&);
 
    private:
    // members
@@ -0,0 +1,88 @@
+/**************************** updatepolicy.cpp ***********************
+
+Decide which property changes signaled by connman are worth a redraw.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./updatepolicy.h"
+
+// default for the smallest strength change that is always shown
+# define STRENGTH_DELTA 10
+
+// constructor
+UpdatePolicy::UpdatePolicy()
+{
+   strength_delta = STRENGTH_DELTA;
+   count_applied = 0;
+   count_suppressed = 0;
+   drawn.clear();
+}
+
+//
+// Function to classify a change to a service property.  rec is the
+// service before the change.  Return true if the change should be
+// redrawn.
+//
+// State and Error always go through.  A Strength change goes through if
+// it moves the signal into a different icon bucket (the same 20/40/60/80
+// steps the tray icon uses) or if it is at least strength_delta away from
+// the value last let through, so a slow drift is shown once it adds up.
+// Without one the value in the record is used, which is what the last
+// full redraw showed.  A strength_delta of zero or less lets every change
+// through.  Everything else goes through.
+bool UpdatePolicy::serviceChange(const ServiceRecord& rec, const QString& prop, const QVariant& value)
+{
+   bool b_apply = true;
+   const QString path = rec.objpath.path();
+   const bool b_strength = prop == "Strength";
+   const int newval = b_strength ? value.value<quint8>() : rec.strength;
+
+   if (b_strength && strength_delta > 0 && rec.strength >= 0) {
+      const int oldval = drawn.value(path, rec.strength);
+      if (strengthBucket(newval) == strengthBucket(oldval) && qAbs(newval - oldval) < strength_delta)
+         b_apply = false;
+   } // if strength
+
+   // the row is redrawn with the strength the record has after the change
+   if (b_apply) {
+      ++count_applied;
+      if (newval >= 0) drawn.insert(path, newval);
+   }
+   else
+      ++count_suppressed;
+
+   return b_apply;
+}
+
+//
+// Function to return the icon bucket (0 to 4) of a signal strength
+int UpdatePolicy::strengthBucket(int str)
+{
+   if (str > 80) return 4;
+      else if (str > 60) return 3;
+         else if (str > 40) return 2;
+            else if (str > 20) return 1;
+
+   return 0;
+}
@@ -0,0 +1,62 @@
+/**************************** updatepolicy.h *************************
+
+Decide which property changes signaled by connman are worth a redraw.
+Wifi signal strength jitters by a few percent all the time, changes
+that would not change anything the user looks at are not redrawn.  The
+store is always updated, only the redraw is skipped.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef UPDATE_POLICY_H
+# define UPDATE_POLICY_H
+
+# include <QString>
+# include <QVariant>
+# include <QHash>
+
+# include "./code/store/records.h"
+
+class UpdatePolicy
+{
+   public:
+      UpdatePolicy();
+
+      bool serviceChange(const ServiceRecord&, const QString&, const QVariant&);
+      static int strengthBucket(int);
+      inline void forget(const QString& path) {drawn.remove(path);}
+
+      inline void setStrengthDelta(int delta) {strength_delta = delta;}
+      inline int strengthDelta() const {return strength_delta;}
+      inline quint32 applied() const {return count_applied;}
+      inline quint32 suppressed() const {return count_suppressed;}
+
+   private:
+      // members
+      int strength_delta;
+      quint32 count_applied;
+      quint32 count_suppressed;
+      QHash<QString,int> drawn;     // strength last let through, by service path
+};
+
+# endif
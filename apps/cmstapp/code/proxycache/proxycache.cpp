@@ -0,0 +1,66 @@
+/**************************** proxycache.cpp *************************
+
+Cache of DBus proxies for the connman objects we send method calls to.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./proxycache.h"
+
+// constructor
+ProxyCache::ProxyCache(const QDBusConnection& conn, QObject* parent) : QObject(parent), connection(conn)
+{
+   proxies.clear();
+}
+
+//
+// Function to remove every proxy for the object at path.  Called when
+// connman tells us the object was removed.  The proxies are deleted
+// later in case a caller further up the stack is still using one.
+void ProxyCache::evict(const QString& path)
+{
+   QMutableHashIterator<QString, QDBusAbstractInterface*> itr(proxies);
+   while (itr.hasNext()) {
+      itr.next();
+      if (itr.value()->path() == path) {
+         itr.value()->deleteLater();
+         itr.remove();
+      } // if
+   } // while
+
+   return;
+}
+
+//
+// Function to remove all of the proxies
+void ProxyCache::clear()
+{
+   QHashIterator<QString, QDBusAbstractInterface*> itr(proxies);
+   while (itr.hasNext()) {
+      itr.next();
+      itr.value()->deleteLater();
+   } // while
+   proxies.clear();
+
+   return;
+}
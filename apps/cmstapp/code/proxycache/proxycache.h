@@ -0,0 +1,82 @@
+/**************************** proxycache.h ***************************
+
+Cache of DBus proxies for the connman objects we send method calls to.
+Proxies are created on first use, without introspection, and kept until
+the object goes away.  The proxy classes are generated by qdbusxml2cpp
+from the net.connman.*.xml files in this directory.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef PROXY_CACHE_H
+# define PROXY_CACHE_H
+
+# include <QObject>
+# include <QString>
+# include <QHash>
+# include <QtDBus/QDBusConnection>
+# include <QtDBus/QDBusAbstractInterface>
+
+# include "service_interface.h"
+# include "technology_interface.h"
+# include "vpnconnection_interface.h"
+
+class ProxyCache : public QObject
+{
+   Q_OBJECT
+
+   public:
+      ProxyCache(const QDBusConnection&, QObject* parent = 0);
+
+      template <class T> T* proxy(const QString&, const QString&);
+      inline NetConnmanServiceInterface* service(const QString& path) {return proxy<NetConnmanServiceInterface>("net.connman", path);}
+      inline NetConnmanTechnologyInterface* technology(const QString& path) {return proxy<NetConnmanTechnologyInterface>("net.connman", path);}
+      inline NetConnmanVpnConnectionInterface* vpnConnection(const QString& path) {return proxy<NetConnmanVpnConnectionInterface>("net.connman.vpn", path);}
+      void evict(const QString&);
+      void clear();
+      inline int count() const {return proxies.size();}
+
+   private:
+      // members
+      QDBusConnection connection;
+      QHash<QString, QDBusAbstractInterface*> proxies;
+};
+
+//
+// Function to return the generated proxy class T for the object at path on
+// service.  The proxy is created the first time it is asked for. The cache
+// owns the proxy, callers must not delete it.
+template <class T> T* ProxyCache::proxy(const QString& service, const QString& path)
+{
+   const QString key = QString("%1|%2|%3").arg(service).arg(path).arg(QLatin1String(T::staticInterfaceName()) );
+
+   QHash<QString, QDBusAbstractInterface*>::const_iterator itr = proxies.constFind(key);
+   if (itr != proxies.constEnd() ) return static_cast<T*>(itr.value());
+
+   T* dbp = new T(service, path, connection, this);
+   proxies.insert(key, dbp);
+
+   return dbp;
+}
+
+# endif
@@ -0,0 +1,446 @@
+/**************************** quota.cpp ******************************
+
+Data quotas for services.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <algorithm>
+
+# include <QDate>
+# include <QDateTime>
+# include <QStringList>
+# include <QRegularExpression>
+# include <QtDBus/QDBusVariant>
+
+# include <syslog.h>
+
+# include "./quota.h"
+# include "../resource.h"
+
+//  The longest wait between period checks, in milliseconds.  The timer is
+//  armed for the earliest period end, but not further out than this so a
+//  suspend or a clock change is noticed in reasonable time.
+# define PERIOD_CHECK_INTERVAL 3600000
+
+// constructor
+QuotaEngine::QuotaEngine(const TrafficHistory* th, ProxyCache* pc, QObject* parent) : QObject(parent)
+{
+   traffic = th;
+   proxies = pc;
+   quotas.clear();
+   restores.clear();
+   restoring.clear();
+
+   period_timer = new QTimer(this);
+   period_timer->setSingleShot(true);
+   connect(period_timer, SIGNAL(timeout()), this, SLOT(checkPeriods()));
+}
+
+//
+// Function to set or change the quota of a service.  The total of the
+// current period is read once from the traffic history.  Thresholds it is
+// already past are not signaled again.  If the service is already over the
+// limit the action is taken now, unless it was taken this period.  If the
+// new quota leaves the service under its limit AutoConnect is given back.
+void QuotaEngine::setQuota(const QString& path, const Quota& quota)
+{
+   if (quota.limit == 0) {
+      this->removeQuota(path);
+      return;
+   }
+
+   QuotaState& qs = quotas[path];
+   qs.quota = quota;
+   this->startPeriod(path, qs);
+   if (qs.used < qs.quota.limit) {
+      qs.capped = 0;
+      this->restoreAutoConnect(path);
+   }
+   else
+      this->checkCap(path, qs);
+   this->schedulePeriodCheck();
+
+   return;
+}
+
+//
+// Function to remove the quota of a service.  AutoConnect is given back
+// if the quota had turned it off.
+void QuotaEngine::removeQuota(const QString& path)
+{
+   if (quotas.remove(path) == 0) return;
+
+   this->restoreAutoConnect(path);
+   this->schedulePeriodCheck();
+
+   return;
+}
+
+//
+// Function to return the quota of a service, the limit is 0 if there is none
+Quota QuotaEngine::quota(const QString& path) const
+{
+   return quotas.contains(path) ? quotas.value(path).quota : Quota();
+}
+
+//
+// Function to return the bytes used in the current period
+quint64 QuotaEngine::used(const QString& path) const
+{
+   return quotas.contains(path) ? quotas.value(path).used : 0;
+}
+
+//
+// Function to return the start of the current period
+qint64 QuotaEngine::periodStart(const QString& path) const
+{
+   return quotas.contains(path) ? quotas.value(path).start : 0;
+}
+
+//
+// Function to add the bytes of a counter delta to a service.  Only the
+// delta is looked at, the totals are never rescanned while a period runs.
+void QuotaEngine::addUsage(const QString& path, quint64 bytes)
+{
+   QHash<QString,QuotaState>::iterator itr = quotas.find(path);
+   if (itr == quotas.end() || bytes == 0) return;
+   QuotaState& qs = itr.value();
+
+   // the period may have ended since the last check
+   if (this->rollOver(path, qs) ) this->schedulePeriodCheck();
+
+   qs.used += bytes;
+   while (qs.next < qs.quota.thresholds.size() && qs.used * 100 >= qs.quota.limit * qs.quota.thresholds.at(qs.next) ) {
+      emit thresholdReached(path, qs.quota.thresholds.at(qs.next), qs.used, qs.quota.limit);
+      ++qs.next;
+   } // while
+   this->checkCap(path, qs);
+
+   return;
+}
+
+//
+// Function to bring the services in line with their quotas once connman
+// has told us about them.  The action is taken for every service over its
+// limit that has not had it this period, for instance because the limit
+// was crossed while we were not running.  AutoConnect is given back to
+// services that are not capped any more.
+void QuotaEngine::sync()
+{
+   QHash<QString,QuotaState>::iterator itr = quotas.begin();
+   while (itr != quotas.end() ) {
+      this->checkCap(itr.key(), itr.value() );
+      ++itr;
+   } // while
+
+   const QList<QString> paths = restores.values();
+   for (int i = 0; i < paths.size(); ++i) {
+      this->restoreAutoConnect(paths.at(i) );
+   } // for
+
+   return;
+}
+
+//
+// Function to retry giving AutoConnect back to services connman has added.
+// A restore fails if the service is not there when the period ends.
+void QuotaEngine::servicesAdded(const QVector<QString>& paths)
+{
+   for (int i = 0; i < paths.size(); ++i) {
+      if (restores.contains(paths.at(i)) ) this->restoreAutoConnect(paths.at(i) );
+   } // for
+
+   return;
+}
+
+//
+// Function to read the quotas from the settings.  Nothing is sent to
+// connman here, sync() does that once the services are known.
+void QuotaEngine::readSettings(QSettings* settings)
+{
+   quotas.clear();
+   restores.clear();
+   restoring.clear();
+   const int size = settings->beginReadArray("Quotas");
+   for (int i = 0; i < size; ++i) {
+      settings->setArrayIndex(i);
+      Quota quota;
+      quota.limit = settings->value("limit").toULongLong();
+      quota.period = settings->value("period", Period_Month).toInt();
+      quota.resetday = settings->value("reset_day", 1).toInt();
+      quota.thresholds = parseThresholds(settings->value("thresholds").toString() );
+      quota.action = settings->value("action", Action_None).toInt();
+      if (quota.limit == 0) continue;
+      QuotaState& qs = quotas[settings->value("service").toString()];
+      qs.quota = quota;
+      qs.capped = settings->value("capped_period", 0).toLongLong();
+      this->startPeriod(settings->value("service").toString(), qs);
+   } // for
+   settings->endArray();
+
+   const QStringList sl = settings->value("quota_restore_autoconnect").toStringList();
+   for (int i = 0; i < sl.size(); ++i) {
+      restores.insert(sl.at(i) );
+   } // for
+   this->schedulePeriodCheck();
+
+   return;
+}
+
+//
+// Function to write the quotas to the settings
+void QuotaEngine::writeSettings(QSettings* settings) const
+{
+   settings->beginWriteArray("Quotas", quotas.size() );
+   int i = 0;
+   QHash<QString,QuotaState>::const_iterator itr = quotas.constBegin();
+   while (itr != quotas.constEnd() ) {
+      settings->setArrayIndex(i++);
+      const Quota& quota = itr.value().quota;
+      QStringList sl;
+      for (int j = 0; j < quota.thresholds.size(); ++j) {
+         sl << QString::number(quota.thresholds.at(j) );
+      } // for
+      settings->setValue("service", itr.key() );
+      settings->setValue("limit", quota.limit);
+      settings->setValue("period", quota.period);
+      settings->setValue("reset_day", quota.resetday);
+      settings->setValue("thresholds", sl.join(", ") );
+      settings->setValue("action", quota.action);
+      settings->setValue("capped_period", itr.value().capped);
+      ++itr;
+   } // while
+   settings->endArray();
+   settings->setValue("quota_restore_autoconnect", QStringList(restores.values()) );
+
+   return;
+}
+
+//
+// Function to turn a list of percentages like "50, 80, 100" into a sorted
+// list without duplicates.  Anything that is not a number above 0 is skipped.
+QList<int> QuotaEngine::parseThresholds(const QString& text)
+{
+   QList<int> rtn;
+   const QStringList sl = text.split(QRegularExpression("[,;\\s]+"), QString::SkipEmptyParts);
+   for (int i = 0; i < sl.size(); ++i) {
+      bool ok = false;
+      const int pct = sl.at(i).toInt(&ok);
+      if (ok && pct > 0 && ! rtn.contains(pct) ) rtn.append(pct);
+   } // for
+   std::sort(rtn.begin(), rtn.end() );
+
+   return rtn;
+}
+
+////////////////////////////////////////////// Private Functions //////////////////////////////////
+//
+// Function to start tracking the current period of a quota.  The total so
+// far comes from the traffic history, thresholds already crossed count as
+// notified.  Whether the action was taken is left alone, it is kept with
+// the period it was taken in.
+void QuotaEngine::startPeriod(const QString& path, QuotaState& qs)
+{
+   periodBounds(qs.quota, qs.start, qs.end);
+   qs.used = traffic->bytesSince(path, qs.start);
+   qs.next = 0;
+   while (qs.next < qs.quota.thresholds.size() && qs.used * 100 >= qs.quota.limit * qs.quota.thresholds.at(qs.next) ) {
+      ++qs.next;
+   } // while
+
+   return;
+}
+
+//
+// Function to start a new period if the current one has ended.  Usage
+// starts from scratch and AutoConnect is given back if the last period
+// turned it off.  Returns true if a new period was started.
+bool QuotaEngine::rollOver(const QString& path, QuotaState& qs)
+{
+   if (QDateTime::currentMSecsSinceEpoch() / 1000 < qs.end) return false;
+
+   periodBounds(qs.quota, qs.start, qs.end);
+   qs.used = 0;
+   qs.next = 0;
+   this->restoreAutoConnect(path);
+   emit periodStarted(path);
+
+   return true;
+}
+
+//
+// Function to take the action if the service is over its limit and the
+// action has not been taken this period
+void QuotaEngine::checkCap(const QString& path, QuotaState& qs)
+{
+   if (qs.capped == qs.start || qs.used < qs.quota.limit) return;
+
+   qs.capped = qs.start;
+   this->enforce(path, qs.quota.action);
+   emit capReached(path, qs.quota.action);
+
+   return;
+}
+
+//
+// Function to work out the local start and end of the period that holds
+// the current time.  A monthly reset day past the end of a short month
+// falls on its last day.
+void QuotaEngine::periodBounds(const Quota& quota, qint64& start, qint64& end)
+{
+   const QDate today = QDate::currentDate();
+   QDate first = today;
+   QDate next = today.addDays(1);
+
+   switch (quota.period) {
+      case Period_Week: {
+         const int rd = qBound(1, quota.resetday, 7);
+         first = today.addDays(-((today.dayOfWeek() - rd + 7) % 7) );
+         next = first.addDays(7);
+         break; }
+
+      case Period_Month: {
+         const int rd = qBound(1, quota.resetday, 31);
+         first = QDate(today.year(), today.month(), qMin(rd, today.daysInMonth()) );
+         if (first > today) {
+            const QDate prev = QDate(today.year(), today.month(), 1).addMonths(-1);
+            first = QDate(prev.year(), prev.month(), qMin(rd, prev.daysInMonth()) );
+         }
+         const QDate nm = QDate(first.year(), first.month(), 1).addMonths(1);
+         next = QDate(nm.year(), nm.month(), qMin(rd, nm.daysInMonth()) );
+         break; }
+
+      default:
+         break;
+   } // switch
+
+   start = QDateTime(first, QTime(0, 0)).toMSecsSinceEpoch() / 1000;
+   end = QDateTime(next, QTime(0, 0)).toMSecsSinceEpoch() / 1000;
+
+   return;
+}
+
+//
+// Function to take the action at the cap.  Disconnect turns AutoConnect
+// off as well, otherwise connman would just connect the service again.
+void QuotaEngine::enforce(const QString& path, int action)
+{
+   if (action == Action_None) return;
+
+   QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(proxies->service(path)->SetProperty("AutoConnect", QDBusVariant(false)), this);
+   connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(actionReplied(QDBusPendingCallWatcher*)));
+
+   if (action == Action_Disconnect) {
+      watcher = new QDBusPendingCallWatcher(proxies->service(path)->Disconnect(), this);
+      connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(actionReplied(QDBusPendingCallWatcher*)));
+   } // if
+
+   // a restore still in flight is overtaken by this call
+   restores.insert(path);
+   restoring.remove(path);
+
+   return;
+}
+
+//
+// Function to turn AutoConnect back on for a service, only if the quota
+// action turned it off and the service is not capped this period.  The
+// service stays in restores until connman says the call worked.
+void QuotaEngine::restoreAutoConnect(const QString& path)
+{
+   if (! restores.contains(path) || restoring.contains(path) ) return;
+   QHash<QString,QuotaState>::const_iterator itr = quotas.constFind(path);
+   if (itr != quotas.constEnd() && itr.value().capped == itr.value().start) return;
+
+   QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(proxies->service(path)->SetProperty("AutoConnect", QDBusVariant(true)), this);
+   watcher->setProperty("restore", path);
+   connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(actionReplied(QDBusPendingCallWatcher*)));
+   restoring.insert(path);
+
+   return;
+}
+
+//
+// Function to arm the timer for the earliest end of a period
+void QuotaEngine::schedulePeriodCheck()
+{
+   if (quotas.isEmpty() ) {
+      period_timer->stop();
+      return;
+   }
+
+   qint64 end = -1;
+   QHash<QString,QuotaState>::const_iterator itr = quotas.constBegin();
+   while (itr != quotas.constEnd() ) {
+      if (end < 0 || itr.value().end < end) end = itr.value().end;
+      ++itr;
+   } // while
+
+   // a second past the boundary so the new period is current when it fires
+   const qint64 wait = (end - QDateTime::currentMSecsSinceEpoch() / 1000 + 1) * 1000;
+   period_timer->start(static_cast<int>(qBound(qint64(1000), wait, qint64(PERIOD_CHECK_INTERVAL))) );
+
+   return;
+}
+
+////////////////////////////////////////////// Private Slots //////////////////////////////////////
+//
+// Slot to start the new period of every quota whose period has ended,
+// whether or not the service has seen any traffic.  Called when
+// period_timer times out.
+void QuotaEngine::checkPeriods()
+{
+   QHash<QString,QuotaState>::iterator itr = quotas.begin();
+   while (itr != quotas.end() ) {
+      this->rollOver(itr.key(), itr.value() );
+      this->checkCap(itr.key(), itr.value() );
+      ++itr;
+   } // while
+   this->schedulePeriodCheck();
+
+   return;
+}
+
+//
+// Slot called when the reply to an action or a restore arrives.  These
+// calls are made from timers and signals, not by the user, so errors go
+// to the system log.  A restore that worked takes the service out of
+// restores, one that failed is tried again when the service is added.
+void QuotaEngine::actionReplied(QDBusPendingCallWatcher* watcher)
+{
+   const QDBusMessage reply = watcher->reply();
+   const QString path = watcher->property("restore").toString();
+   watcher->deleteLater();
+
+   // a restore overtaken by a new action leaves restores alone
+   if (! path.isEmpty() && restoring.remove(path) && reply.type() != QDBusMessage::ErrorMessage) restores.remove(path);
+
+   if (reply.type() == QDBusMessage::ErrorMessage) {
+      openlog(qPrintable(LOG_NAME), LOG_PID|LOG_CONS, LOG_USER);
+      syslog(LOG_WARNING, "%s", tr("Data quota: %1 failed: %2").arg(path.isEmpty() ? tr("Action") : tr("AutoConnect restore for %1").arg(path)).arg(reply.errorMessage()).toUtf8().constData() );
+      closelog();
+   } // if
+
+   return;
+}
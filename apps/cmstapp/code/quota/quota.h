@@ -0,0 +1,134 @@
+/**************************** quota.h ********************************
+
+Data quotas for services.  Each counter delta is added to the running
+total of the service's current period, notifications are signaled as
+the total crosses the configured percentages and the service can have
+AutoConnect turned off or be disconnected at the cap.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef QUOTA_ENGINE_H
+# define QUOTA_ENGINE_H
+
+# include <QObject>
+# include <QString>
+# include <QHash>
+# include <QSet>
+# include <QVector>
+# include <QList>
+# include <QSettings>
+# include <QTimer>
+# include <QDBusPendingCallWatcher>
+
+# include "./code/traffic/traffichistory.h"
+# include "./code/proxycache/proxycache.h"
+
+//
+// Quota of one service
+struct Quota
+{
+   quint64 limit;          // bytes in a period
+   int period;             // QuotaEngine::Period
+   int resetday;           // day of the month or of the week (1 is Monday) a period starts
+   QList<int> thresholds;  // percentages of the limit to notify at, ascending
+   int action;             // QuotaEngine::Action at the limit
+
+   Quota() : limit(0), period(2), resetday(1), action(0) {}
+};
+
+class QuotaEngine : public QObject
+{
+   Q_OBJECT
+
+   public:
+      enum Period {
+         Period_Day = 0,
+         Period_Week = 1,
+         Period_Month = 2
+      };
+
+      enum Action {
+         Action_None = 0,
+         Action_AutoConnectOff = 1,
+         Action_Disconnect = 2
+      };
+
+      QuotaEngine(const TrafficHistory*, ProxyCache*, QObject* parent = 0);
+
+      void setQuota(const QString&, const Quota&);
+      void removeQuota(const QString&);
+      inline bool hasQuota(const QString& path) const {return quotas.contains(path);}
+      Quota quota(const QString&) const;
+      quint64 used(const QString&) const;
+      qint64 periodStart(const QString&) const;
+      void addUsage(const QString&, quint64);
+      void sync();
+      void servicesAdded(const QVector<QString>&);
+      void readSettings(QSettings*);
+      void writeSettings(QSettings*) const;
+      static QList<int> parseThresholds(const QString&);
+
+   signals:
+      void thresholdReached(const QString&, int, quint64, quint64);
+      void capReached(const QString&, int);
+      void periodStarted(const QString&);
+
+   private:
+      //
+      // Running state of a quota for the current period
+      struct QuotaState
+      {
+         Quota quota;
+         qint64 start;        // current period, seconds since the epoch
+         qint64 end;
+         quint64 used;
+         int next;            // index of the next threshold to notify
+         qint64 capped;       // start of the period the action was taken in, 0 if none
+
+         QuotaState() : start(0), end(0), used(0), next(0), capped(0) {}
+      };
+
+      // members
+      const TrafficHistory* traffic;
+      ProxyCache* proxies;
+      QHash<QString,QuotaState> quotas;
+      QSet<QString> restores;       // services the action turned AutoConnect off for
+      QSet<QString> restoring;      // services with an AutoConnect restore in flight
+      QTimer* period_timer;
+
+      // functions
+      void startPeriod(const QString&, QuotaState&);
+      bool rollOver(const QString&, QuotaState&);
+      void checkCap(const QString&, QuotaState&);
+      static void periodBounds(const Quota&, qint64&, qint64&);
+      void enforce(const QString&, int);
+      void restoreAutoConnect(const QString&);
+      void schedulePeriodCheck();
+
+   private slots:
+      void checkPeriods();
+      void actionReplied(QDBusPendingCallWatcher*);
+};
+
+# endif
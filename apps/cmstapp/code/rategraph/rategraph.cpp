@@ -0,0 +1,184 @@
+/**************************** rategraph.cpp **************************
+
+Widget to draw one tier of a RateHistory as a scrolling graph.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QPainter>
+# include <QPaintEvent>
+# include <QResizeEvent>
+
+# include "./rategraph.h"
+
+// smallest scale, 1 KB/s, so an idle link is not drawn full height
+# define MIN_SCALE 1024.0
+
+// constructor
+RateGraph::RateGraph(QWidget* parent) : QWidget(parent)
+{
+   hist = 0;
+   tier = RateHistory::Tier_Second;
+   drawn = 0;
+   scrolled = 0;
+   f_scale = MIN_SCALE;
+
+   this->setAttribute(Qt::WA_OpaquePaintEvent);
+   this->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+}
+
+//
+// Function to return the preferred size
+QSize RateGraph::sizeHint() const
+{
+   return QSize(300, 100);
+}
+
+//
+// Function to return a rate as text, in the same units the counter labels use
+QString RateGraph::rateText(double bps)
+{
+   if (bps < 1024 * 1.875) return tr("%L1 B/s").arg(bps, 0, 'f', 0);
+   if (bps < 1024 * 1024 * 1.875) return tr("%L1 KB/s").arg(bps / 1024, 0, 'f', 1);
+   if (bps < 1024 * 1024 * 1024 * 1.875) return tr("%L1 MB/s").arg(bps / (1024 * 1024), 0, 'f', 1);
+
+   return tr("%L1 GB/s").arg(bps / (1024 * 1024 * 1024), 0, 'f', 1);
+}
+
+//
+// Function to set the history and tier to draw.  If they are the ones
+// already shown only the points appended since the last call are drawn,
+// the rest of the pixmap and of the widget is scrolled left.  Call with a null history to
+// clear the graph.
+void RateGraph::setHistory(const RateHistory* rh, int t)
+{
+   if (rh != hist || t != tier || rh == 0 || pixmap.isNull() ) {
+      hist = rh;
+      tier = t;
+      this->redraw();
+      return;
+   }
+
+   const RingBuffer<RatePoint>& rb = hist->tier(tier);
+   const int n = static_cast<int>(qMin(rb.pushed() - drawn, static_cast<quint64>(rb.size())) );
+   if (n <= 0) return;
+
+   // a full redraw if the new points don't fit the scale, or once the
+   // whole width has scrolled by so the scale can come back down
+   bool b_full = n >= this->columns() || scrolled + n >= this->columns();
+   for (int i = rb.size() - n; ! b_full && i < rb.size(); ++i) {
+      if (rb.at(i).rx > f_scale || rb.at(i).tx > f_scale) b_full = true;
+   } // for
+   if (b_full) {
+      this->redraw();
+      return;
+   }
+
+   // scroll the old columns out and draw the new ones on the right
+   const int dx = n * COLUMN_WIDTH;
+   const int right = this->columns() * COLUMN_WIDTH;
+   pixmap.scroll(-dx, 0, QRect(0, 0, right, height()) );
+   QPainter p(&pixmap);
+   p.fillRect(QRect(right - dx, 0, dx, height()), palette().color(QPalette::Base) );
+   for (int i = 0; i < n; ++i) {
+      this->drawColumn(p, this->columns() - n + i, rb.at(rb.size() - n + i) );
+   } // for
+   p.end();
+
+   drawn = rb.pushed();
+   scrolled += n;
+
+   // move what is on the screen the same way, only the new strip is painted
+   this->scroll(-dx, 0, QRect(0, 0, right, height()) );
+   this->update(QRect(right - dx, 0, dx, height()) );
+
+   return;
+}
+
+//
+// Function to rebuild the whole pixmap
+void RateGraph::redraw()
+{
+   pixmap = QPixmap(this->size() );
+   pixmap.fill(palette().color(QPalette::Base) );
+   drawn = 0;
+   scrolled = 0;
+   f_scale = MIN_SCALE;
+
+   if (hist != 0 && this->columns() > 0) {
+      const RingBuffer<RatePoint>& rb = hist->tier(tier);
+      const int n = qMin(rb.size(), this->columns() );
+
+      // scale to the largest point shown, with a little head room
+      for (int i = rb.size() - n; i < rb.size(); ++i) {
+         f_scale = qMax(f_scale, qMax(rb.at(i).rx, rb.at(i).tx) );
+      } // for
+      f_scale *= 1.25;
+
+      QPainter p(&pixmap);
+      for (int i = 0; i < n; ++i) {
+         this->drawColumn(p, this->columns() - n + i, rb.at(rb.size() - n + i) );
+      } // for
+      drawn = rb.pushed();
+   } // if
+
+   this->update();
+
+   return;
+}
+
+//
+// Function to draw one column.  Receive is a bar from the bottom, transmit
+// is a mark on top of it.
+void RateGraph::drawColumn(QPainter& p, int col, const RatePoint& pt)
+{
+   const int h = this->height();
+   const int x = col * COLUMN_WIDTH;
+   const int yrx = h - qRound(pt.rx / f_scale * h);
+   const int ytx = h - qRound(pt.tx / f_scale * h);
+
+   p.fillRect(QRect(x, yrx, COLUMN_WIDTH, h - yrx), palette().color(QPalette::Highlight) );
+   p.fillRect(QRect(x, qMin(ytx, h - 2), COLUMN_WIDTH, 2), palette().color(QPalette::Text) );
+
+   return;
+}
+
+//
+// Paint event, copy the parts of the pixmap that need it
+void RateGraph::paintEvent(QPaintEvent* e)
+{
+   QPainter p(this);
+   p.drawPixmap(e->rect(), pixmap, e->rect() );
+
+   return;
+}
+
+//
+// Resize event, the columns don't line up any more so start again
+void RateGraph::resizeEvent(QResizeEvent* e)
+{
+   QWidget::resizeEvent(e);
+   this->redraw();
+
+   return;
+}
@@ -0,0 +1,74 @@
+/**************************** rategraph.h ****************************
+
+Widget to draw one tier of a RateHistory as a scrolling graph.  The
+graph is kept in a pixmap, when points are appended the pixmap is
+scrolled and only the new columns are drawn.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef RATE_GRAPH_H
+# define RATE_GRAPH_H
+
+# include <QWidget>
+# include <QPixmap>
+# include <QString>
+
+# include "./code/rategraph/ratehistory.h"
+
+class RateGraph : public QWidget
+{
+   Q_OBJECT
+
+   public:
+      RateGraph(QWidget* parent = 0);
+
+      void setHistory(const RateHistory*, int);
+      inline const RateHistory* history() const {return hist;}
+      inline float scale() const {return f_scale;}
+      QSize sizeHint() const;
+      static QString rateText(double);
+
+   protected:
+      void paintEvent(QPaintEvent*);
+      void resizeEvent(QResizeEvent*);
+
+   private:
+      // members
+      const RateHistory* hist;
+      int tier;
+      QPixmap pixmap;
+      quint64 drawn;       // pushed() count of the tier when last drawn
+      int scrolled;        // columns scrolled since the last full redraw
+      float f_scale;       // bytes per second at the top of the graph
+
+      // functions
+      void redraw();
+      void drawColumn(QPainter&, int, const RatePoint&);
+      inline int columns() const {return width() / COLUMN_WIDTH;}
+
+   public:
+      static const int COLUMN_WIDTH = 2;
+};
+
+# endif
@@ -0,0 +1,112 @@
+/**************************** ratehistory.cpp ************************
+
+Transfer rates of a service kept in fixed size ring buffers.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include "./ratehistory.h"
+
+// points kept in each tier, 10 minutes of seconds, a day of minutes and
+// a month of hours
+# define SECOND_POINTS 600
+# define MINUTE_POINTS 1440
+# define HOUR_POINTS 720
+
+// milliseconds covered by one point of each tier
+static const qint64 tier_ms[RateHistory::Tier_Count] = {1000, 60 * 1000, 60 * 60 * 1000};
+
+// constructor
+RateHistory::RateHistory()
+{
+   tiers[Tier_Second] = RingBuffer<RatePoint>(SECOND_POINTS);
+   tiers[Tier_Minute] = RingBuffer<RatePoint>(MINUTE_POINTS);
+   tiers[Tier_Hour] = RingBuffer<RatePoint>(HOUR_POINTS);
+   for (int t = 0; t < Tier_Count; ++t) {
+      acc_ms[t] = 0;
+      acc_rx[t] = 0.0;
+      acc_tx[t] = 0.0;
+   } // for
+
+   last_ms = 0;
+   last_rx = 0;
+   last_tx = 0;
+   b_base = false;
+}
+
+//
+// Function to add a counter sample.  msecs is a monotonic time stamp,
+// rx and tx the byte totals from connman.  The bytes since the last sample
+// are spread over the time since the last sample and added to every tier.
+// A tier gets a new point each time it has collected a full period.
+//
+// The first sample and any sample where the totals went backwards (the
+// counters were reset or a service dropped out of a sum) only set the base.
+//
+// Return a bitmask of the tiers that got new points.
+int RateHistory::addSample(qint64 msecs, quint64 rx, quint64 tx)
+{
+   int rtn = 0;
+
+   if (b_base && msecs > last_ms && rx >= last_rx && tx >= last_tx) {
+      const qint64 dt = msecs - last_ms;
+      const double drx = static_cast<double>(rx - last_rx);
+      const double dtx = static_cast<double>(tx - last_tx);
+
+      for (int t = 0; t < Tier_Count; ++t) {
+         acc_ms[t] += dt;
+         acc_rx[t] += drx;
+         acc_tx[t] += dtx;
+         if (acc_ms[t] < tier_ms[t]) continue;
+
+         // one point for each whole period, all with the average rate so a
+         // slow sample still gives evenly spaced points
+         const RatePoint pt(acc_rx[t] * 1000.0 / acc_ms[t], acc_tx[t] * 1000.0 / acc_ms[t]);
+         const int n = qMin(acc_ms[t] / tier_ms[t], static_cast<qint64>(tiers[t].capacity()) );
+         for (int i = 0; i < n; ++i) {
+            tiers[t].append(pt);
+         } // for
+         acc_ms[t] %= tier_ms[t];
+         acc_rx[t] = pt.rx * acc_ms[t] / 1000.0;
+         acc_tx[t] = pt.tx * acc_ms[t] / 1000.0;
+         rtn |= (1 << t);
+      } // for
+   } // if
+
+   this->setBase(msecs, rx, tx);
+
+   return rtn;
+}
+
+//
+// Function to set the totals the next sample is measured from without
+// adding a point.  Used when a sum jumps for a reason that is not traffic.
+void RateHistory::setBase(qint64 msecs, quint64 rx, quint64 tx)
+{
+   last_ms = msecs;
+   last_rx = rx;
+   last_tx = tx;
+   b_base = true;
+
+   return;
+}
@@ -0,0 +1,105 @@
+/**************************** ratehistory.h **************************
+
+Transfer rates of a service kept in fixed size ring buffers.  Each
+counter sample is turned into a rate as it arrives and folded into
+three tiers, one point per second, per minute and per hour, so nothing
+is recomputed when the graph is drawn.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef RATE_HISTORY_H
+# define RATE_HISTORY_H
+
+# include <QVector>
+# include <QtGlobal>
+
+//
+// A fixed size ring buffer.  Once full the oldest element is overwritten.
+// at(0) is the oldest element, at(size() - 1) the newest.
+template <typename T>
+class RingBuffer
+{
+   public:
+      RingBuffer(int cap = 1) : buf(qMax(cap, 1)), head(0), used(0), total(0) {}
+
+      inline int size() const {return used;}
+      inline int capacity() const {return buf.size();}
+      inline bool isEmpty() const {return used == 0;}
+      inline quint64 pushed() const {return total;}
+      inline const T& at(int i) const {return buf.at((head + buf.size() - used + i) % buf.size());}
+      inline const T& last() const {return at(used - 1);}
+      inline void clear() {head = 0; used = 0;}
+
+      inline void append(const T& t) {
+         buf[head] = t;
+         head = (head + 1) % buf.size();
+         if (used < buf.size()) ++used;
+         ++total; }
+
+   private:
+      QVector<T> buf;
+      int head;         // where the next element goes
+      int used;
+      quint64 total;    // elements ever appended, lets a reader find what is new
+};
+
+//
+// Receive and transmit rate in bytes per second
+struct RatePoint
+{
+   float rx;
+   float tx;
+
+   RatePoint(float r = 0.0, float t = 0.0) : rx(r), tx(t) {}
+};
+
+class RateHistory
+{
+   public:
+      enum Tier {
+         Tier_Second = 0,
+         Tier_Minute = 1,
+         Tier_Hour = 2,
+         Tier_Count = 3
+      };
+
+      RateHistory();
+
+      int addSample(qint64, quint64, quint64);
+      void setBase(qint64, quint64, quint64);
+      inline const RingBuffer<RatePoint>& tier(int t) const {return tiers[t];}
+
+   private:
+      // members
+      RingBuffer<RatePoint> tiers[Tier_Count];
+      qint64 acc_ms[Tier_Count];
+      double acc_rx[Tier_Count];
+      double acc_tx[Tier_Count];
+      qint64 last_ms;
+      quint64 last_rx;
+      quint64 last_tx;
+      bool b_base;
+};
+
+# endif
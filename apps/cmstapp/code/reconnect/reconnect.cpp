@@ -0,0 +1,266 @@
+/**************************** reconnect.cpp ***************************
+
+Scheduler to reconnect services that fell into the failure state.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QDateTime>
+# include <QRandomGenerator>
+
+# include "./reconnect.h"
+# include "service_interface.h"
+
+// delay before the first attempt, doubled for each attempt after that
+# define RECONNECT_BASE 5000
+// longest delay between attempts
+# define RECONNECT_MAX 300000
+// jitter in percent of the delay, either way
+# define RECONNECT_JITTER 20
+// attempts per service before we give up
+# define RECONNECT_BUDGET 6
+// history lines kept per service
+# define RECONNECT_HISTORY 10
+
+// constructor
+ReconnectScheduler::ReconnectScheduler(const ConnmanStore* st, ProxyCache* pc, QObject* parent) : QObject(parent)
+{
+   store = st;
+   proxies = pc;
+   b_enabled = false;
+   entries.clear();
+   calls.clear();
+   timer = new QTimer(this);
+   timer->setSingleShot(true);
+   clock.start();
+
+   connect(timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+//
+// Function to schedule an attempt for every favorite wifi service the
+// store has in the failure state.  State changes only tell us about
+// services that fail from now on, this picks up the ones that had
+// already failed when the services list was read or the scheduler was
+// turned on.  Services with an attempt scheduled are left alone.
+void ReconnectScheduler::sync()
+{
+   if (! b_enabled) return;
+
+   for (int i = 0; i < store->services().size(); ++i) {
+      const ServiceRecord& rec = store->services().at(i);
+      if (rec.state == ServiceRecord::State_Failure) stateChanged(rec.objpath.path(), rec.state, rec.type == ServiceRecord::Type_Wifi && rec.favorite);
+   } // for
+
+   return;
+}
+
+//
+// Function called when the State of a service changed.  eligible is true
+// if the service is one we should try to reconnect (favorite wifi).
+void ReconnectScheduler::stateChanged(const QString& path, ServiceRecord::State state, bool eligible)
+{
+   switch (state) {
+      case ServiceRecord::State_Failure: {
+         if (! b_enabled || ! eligible) return;
+         ReconnectEntry& entry = entries[path];
+         if (entry.due >= 0) return;   // an attempt is already scheduled
+         if (entry.attempts >= RECONNECT_BUDGET) {
+            if (! entry.b_exhausted) {
+               entry.b_exhausted = true;
+               note(path, entry, tr("Gave up after %n attempt(s)", "", entry.attempts) );
+            }
+            return;
+         } // if budget used up
+         schedule(path, entry);
+         break; }
+
+      case ServiceRecord::State_Ready:
+      case ServiceRecord::State_Online: {
+         QMap<QString, ReconnectEntry>::iterator itr = entries.find(path);
+         if (itr == entries.end() ) return;
+         if (itr.value().attempts > 0) note(path, itr.value(), tr("Connected after %n attempt(s)", "", itr.value().attempts) );
+         itr.value().attempts = 0;
+         itr.value().due = -1;
+         itr.value().b_exhausted = false;
+         armTimer();
+         break; }
+
+      // disconnected by the user or connman, drop a pending attempt
+      case ServiceRecord::State_Idle:
+      case ServiceRecord::State_Disconnect: {
+         QMap<QString, ReconnectEntry>::iterator itr = entries.find(path);
+         if (itr == entries.end() || itr.value().due < 0) return;
+         itr.value().due = -1;
+         note(path, itr.value(), tr("Retry cancelled, service disconnected") );
+         armTimer();
+         break; }
+
+      // association and configuration, an attempt is under way
+      default:
+         break;
+   } // switch
+
+   return;
+}
+
+//
+// Function to forget a service, called when connman removes it
+void ReconnectScheduler::remove(const QString& path)
+{
+   if (entries.remove(path) > 0) armTimer();
+
+   return;
+}
+
+//
+// Function to return true if an attempt is scheduled for the service
+bool ReconnectScheduler::isPending(const QString& path) const
+{
+   QMap<QString, ReconnectEntry>::const_iterator itr = entries.constFind(path);
+
+   return itr != entries.constEnd() && itr.value().due >= 0;
+}
+
+//
+// Function to return the attempt history for the service, oldest first
+QStringList ReconnectScheduler::history(const QString& path) const
+{
+   return entries.value(path).history;
+}
+
+//
+// Slot to turn the scheduler on or off.  Turning it on schedules the
+// services already in failure, turning it off drops every pending attempt.
+void ReconnectScheduler::setEnabled(bool enabled)
+{
+   b_enabled = enabled;
+   if (b_enabled) {
+      sync();
+      return;
+   }
+
+   QMutableMapIterator<QString, ReconnectEntry> itr(entries);
+   while (itr.hasNext()) {
+      itr.next();
+      itr.value().due = -1;
+   } // while
+   timer->stop();
+
+   return;
+}
+
+////////////////////////////////////////////// Private Functions //////////////////////////////////
+//
+// Function to schedule the next attempt for a service.  The delay doubles
+// with every attempt up to RECONNECT_MAX and is moved by up to
+// RECONNECT_JITTER percent so several services don't all retry at once.
+void ReconnectScheduler::schedule(const QString& path, ReconnectEntry& entry)
+{
+   qint64 delay = qMin(static_cast<qint64>(RECONNECT_BASE) << entry.attempts, static_cast<qint64>(RECONNECT_MAX) );
+   const qint64 jitter = delay * RECONNECT_JITTER / 100;
+   delay += QRandomGenerator::global()->bounded(static_cast<int>(2 * jitter + 1)) - jitter;
+
+   entry.due = clock.elapsed() + delay;
+   note(path, entry, tr("Failure, attempt %1 of %2 in %3 seconds").arg(entry.attempts + 1).arg(RECONNECT_BUDGET).arg((delay + 500) / 1000) );
+   armTimer();
+
+   return;
+}
+
+//
+// Function to start the timer for the attempt that is due first
+void ReconnectScheduler::armTimer()
+{
+   qint64 next = -1;
+   QMap<QString, ReconnectEntry>::const_iterator itr;
+   for (itr = entries.constBegin(); itr != entries.constEnd(); ++itr) {
+      if (itr.value().due >= 0 && (next < 0 || itr.value().due < next) ) next = itr.value().due;
+   } // for
+
+   if (next < 0) timer->stop();
+      else timer->start(static_cast<int>(qMax(static_cast<qint64>(0), next - clock.elapsed())) );
+
+   return;
+}
+
+//
+// Function to add a line to the history of a service
+void ReconnectScheduler::note(const QString& path, ReconnectEntry& entry, const QString& text)
+{
+   entry.history.append(QString("%1  %2").arg(QDateTime::currentDateTime().toString("hh:mm:ss")).arg(text) );
+   while (entry.history.count() > RECONNECT_HISTORY) entry.history.removeFirst();
+   emit historyChanged(path);
+
+   return;
+}
+
+////////////////////////////////////////////// Private Slots //////////////////////////////////////
+//
+// Slot called when the timer fires.  Send a Connect to every service
+// whose attempt is due.
+void ReconnectScheduler::timeout()
+{
+   const qint64 now = clock.elapsed();
+   QMutableMapIterator<QString, ReconnectEntry> itr(entries);
+   while (itr.hasNext()) {
+      itr.next();
+      if (itr.value().due < 0 || itr.value().due > now) continue;
+      itr.value().due = -1;
+      ++itr.value().attempts;
+      note(itr.key(), itr.value(), tr("Attempt %1").arg(itr.value().attempts) );
+      QDBusPendingCallWatcher* watcher = new QDBusPendingCallWatcher(proxies->service(itr.key())->Connect(), this);
+      calls.insert(watcher, itr.key());
+      connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(connectReplied(QDBusPendingCallWatcher*)));
+   } // while
+
+   armTimer();
+
+   return;
+}
+
+//
+// Slot called when the reply to a Connect arrives.  An error is noted and
+// the next attempt scheduled, a success is seen later as a State change.
+// A timeout is left for the State changes to sort out.
+void ReconnectScheduler::connectReplied(QDBusPendingCallWatcher* watcher)
+{
+   const QString path = calls.take(watcher);
+   const QDBusMessage reply = watcher->reply();
+   watcher->deleteLater();
+
+   if (reply.type() != QDBusMessage::ErrorMessage || reply.errorName() == "org.freedesktop.DBus.Error.NoReply") return;
+
+   QMap<QString, ReconnectEntry>::iterator itr = entries.find(path);
+   if (itr == entries.end() ) return;
+
+   note(path, itr.value(), reply.errorMessage().isEmpty() ? reply.errorName() : reply.errorMessage() );
+   if (! b_enabled || itr.value().due >= 0) return;
+   if (itr.value().attempts >= RECONNECT_BUDGET) {
+      itr.value().b_exhausted = true;
+      note(path, itr.value(), tr("Gave up after %n attempt(s)", "", itr.value().attempts) );
+   }
+   else schedule(path, itr.value());
+
+   return;
+}
@@ -0,0 +1,96 @@
+/**************************** reconnect.h *****************************
+
+Scheduler to reconnect services that fell into the failure state.
+Attempts are spaced out with an exponential backoff plus some jitter,
+each service has a budget of attempts, and the Connect calls are sent
+asynchronously.  Driven by service State changes, not by redraws.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef RECONNECT_SCHEDULER_H
+# define RECONNECT_SCHEDULER_H
+
+# include <QObject>
+# include <QString>
+# include <QStringList>
+# include <QMap>
+# include <QHash>
+# include <QTimer>
+# include <QElapsedTimer>
+# include <QDBusPendingCallWatcher>
+
+# include "./code/store/store.h"
+# include "./code/proxycache/proxycache.h"
+
+struct ReconnectEntry
+{
+   int attempts;           // attempts since the service was last connected
+   qint64 due;             // when the next attempt is due on the scheduler clock, -1 if none
+   bool b_exhausted;       // the attempt budget is used up
+   QStringList history;    // oldest first
+
+   ReconnectEntry() : attempts(0), due(-1), b_exhausted(false) {}
+};
+
+class ReconnectScheduler : public QObject
+{
+   Q_OBJECT
+
+   public:
+      ReconnectScheduler(const ConnmanStore*, ProxyCache*, QObject* parent = 0);
+
+      void sync();
+      void stateChanged(const QString&, ServiceRecord::State, bool);
+      void remove(const QString&);
+      bool isPending(const QString&) const;
+      QStringList history(const QString&) const;
+      inline bool isEnabled() const {return b_enabled;}
+
+   public slots:
+      void setEnabled(bool);
+
+   signals:
+      void historyChanged(const QString&);
+
+   private:
+      // members
+      const ConnmanStore* store;
+      ProxyCache* proxies;
+      bool b_enabled;
+      QMap<QString, ReconnectEntry> entries;
+      QHash<QDBusPendingCallWatcher*, QString> calls;
+      QTimer* timer;
+      QElapsedTimer clock;
+
+      // functions
+      void schedule(const QString&, ReconnectEntry&);
+      void armTimer();
+      void note(const QString&, ReconnectEntry&, const QString&);
+
+   private slots:
+      void timeout();
+      void connectReplied(QDBusPendingCallWatcher*);
+};
+
+# endif
@@ -52,6 +52,16 @@ QDBusMessage::MessageType shared::processReply(const QDBusMessage& reply)
   return reply.type();
 }
 
+//
+// Overload for the calls made with the generated proxies.  Wait for the
+// reply and then process it as above.
+QDBusMessage::MessageType shared::processReply(QDBusPendingCall call)
+{
+  call.waitForFinished();
+
+  return processReply(call.reply() );
+}
+
 //
 //  Function to extract the data from a QDBusArgument that contains a map.
 //  Some of the arrayElements can contain a QDBusArgument as the object
@@ -60,10 +70,18 @@ QDBusMessage::MessageType shared::processReply(const QDBusMessage& reply)
 //
 //  Return value a bool, true on success, false otherwise.
 //  The map is sent by reference (called r_map here) and is modified by this function.
-//  r_var is a constant reference to the QDBusArgument.
+//  r_var is a constant reference to the QDBusArgument. r_var may also hold a
+//  QVariantMap, which is what the service records store once the nested
+//  dictionaries have been decoded, in which case the map is copied out.
 //
 bool shared::extractMapData(QMap<QString,QVariant>& r_map, const QVariant& r_var)
 {
+  // already decoded
+  if (r_var.userType() == QMetaType::QVariantMap) {
+    r_map = r_var.toMap();
+    return true;
+  }
+
   //  make sure we can convert the QVariant into a QDBusArgument
   if (! r_var.canConvert<QDBusArgument>() ) return false;
   const QDBusArgument qdba =  r_var.value<QDBusArgument>();
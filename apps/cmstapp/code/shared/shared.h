@@ -39,6 +39,7 @@ DEALINGS IN THE SOFTWARE.
 # include <QPushButton>
 # include <QValidator>
 # include <QDBusInterface>
+# include <QDBusPendingCall>
 
 namespace shared {
 //
@@ -70,6 +71,7 @@ class ValidatingDialog : public QDialog
 }; // class
 
 QDBusMessage::MessageType processReply(const QDBusMessage& reply);
+QDBusMessage::MessageType processReply(QDBusPendingCall call);
 bool extractMapData(QMap<QString,QVariant>&,const QVariant&);
 
 
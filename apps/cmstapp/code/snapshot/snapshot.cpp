@@ -0,0 +1,234 @@
+/**************************** snapshot.cpp ***************************
+
+Snapshot of the store written to the cache directory.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QFile>
+# include <QFileInfo>
+# include <QDir>
+# include <QSaveFile>
+# include <QDataStream>
+# include <QProcessEnvironment>
+# include <QtDBus/QDBusArgument>
+
+# include "./snapshot.h"
+# include "./code/shared/shared.h"
+
+// file header
+# define SNAPSHOT_MAGIC 0x434d5354
+# define SNAPSHOT_VERSION 1
+
+namespace
+{
+   //
+   // Function to read a list of (path, properties) pairs back into records
+   template <class T> bool readList(QDataStream& in, QList<T>& list)
+   {
+      qint32 count = 0;
+      in >> count;
+      if (count < 0 || in.status() != QDataStream::Ok) return false;
+
+      for (qint32 i = 0; i < count; ++i) {
+         QString path;
+         QMap<QString,QVariant> map;
+         in >> path >> map;
+         if (in.status() != QDataStream::Ok) return false;
+
+         T rec;
+         rec.objpath = QDBusObjectPath(path);
+         QMapIterator<QString,QVariant> itr(map);
+         while (itr.hasNext()) {
+            itr.next();
+            rec.setProperty(itr.key(), itr.value() );
+         } // while
+         list.append(rec);
+      } // for
+
+      return true;
+   }
+
+   //
+   // arrayElement has no setProperty(), the map is read as it is
+   bool readElements(QDataStream& in, QList<arrayElement>& list)
+   {
+      qint32 count = 0;
+      in >> count;
+      if (count < 0 || in.status() != QDataStream::Ok) return false;
+
+      for (qint32 i = 0; i < count; ++i) {
+         QString path;
+         arrayElement ae;
+         in >> path >> ae.objmap;
+         if (in.status() != QDataStream::Ok) return false;
+         ae.objpath = QDBusObjectPath(path);
+         list.append(ae);
+      } // for
+
+      return true;
+   }
+} // namespace
+
+// constructor
+StoreSnapshot::StoreSnapshot()
+{
+   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+   QString HOME = env.value("HOME");
+   QString XDG_CACHE_HOME = env.value("XDG_CACHE_HOME", QFileInfo(QDir(HOME), ".cache").absoluteFilePath());
+   filename = QFileInfo(QDir(QFileInfo(QDir(XDG_CACHE_HOME), "cmst").absoluteFilePath()), "state.snapshot").absoluteFilePath();
+   written.clear();
+}
+
+//
+// Function to fill the store from the snapshot file.  The file is memory
+// mapped and read in place.  Nothing in the store is touched unless the
+// whole file could be read.  Return true if the store was filled.
+bool StoreSnapshot::load(ConnmanStore& store)
+{
+   QFile file(filename);
+   if (! file.open(QIODevice::ReadOnly) ) return false;
+   const qint64 size = file.size();
+   if (size <= 0) return false;
+   uchar* data = file.map(0, size);
+   if (data == NULL) return false;
+
+   QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size) );
+   QDataStream in(bytes);
+
+   quint32 magic = 0;
+   quint16 version = 0;
+   in >> magic >> version;
+   bool b_ok = (magic == SNAPSHOT_MAGIC && version == SNAPSHOT_VERSION);
+
+   QMap<QString,QVariant> properties;
+   QList<TechnologyRecord> technologies;
+   QList<ServiceRecord> services;
+   QList<arrayElement> vpnconnections;
+   if (b_ok) {
+      in.setVersion(QDataStream::Qt_5_6);
+      in >> properties;
+      b_ok = in.status() == QDataStream::Ok &&
+         readList(in, technologies) &&
+         readList(in, services) &&
+         readElements(in, vpnconnections);
+   } // if header ok
+
+   file.unmap(data);
+   file.close();
+   if (! b_ok) return false;
+
+   store.setProperties(properties);
+   store.setTechnologies(technologies);
+   store.setServices(services);
+   store.setVPNConnections(vpnconnections);
+
+   return true;
+}
+
+//
+// Function to write the store to the snapshot file.  Nothing is written
+// if the store has not changed since the last save.  The file is only
+// readable by the user and replaced atomically.
+bool StoreSnapshot::save(const ConnmanStore& store)
+{
+   const QByteArray bytes = serialize(store);
+   if (bytes == written) return true;
+
+   QDir dir = QFileInfo(filename).dir();
+   if (! dir.exists() && ! dir.mkpath(dir.absolutePath()) ) return false;
+
+   QSaveFile file(filename);
+   if (! file.open(QIODevice::WriteOnly) ) return false;
+   file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+   if (file.write(bytes) != bytes.size() || ! file.commit() ) return false;
+
+   written = bytes;
+
+   return true;
+}
+
+////////////////////////////////////////////// Private Functions //////////////////////////////////
+//
+// Function to serialize the store into a byte array
+QByteArray StoreSnapshot::serialize(const ConnmanStore& store) const
+{
+   QByteArray bytes;
+   QDataStream out(&bytes, QIODevice::WriteOnly);
+   out << static_cast<quint32>(SNAPSHOT_MAGIC) << static_cast<quint16>(SNAPSHOT_VERSION);
+   out.setVersion(QDataStream::Qt_5_6);
+
+   out << streamable(store.properties() );
+
+   // the tethering passphrase does not belong in a cache file
+   out << static_cast<qint32>(store.technologies().count() );
+   for (int i = 0; i < store.technologies().count(); ++i) {
+      QMap<QString,QVariant> map = streamable(store.technologies().at(i).toMap() );
+      map.remove("TetheringPassphrase");
+      out << store.technologies().at(i).objpath.path() << map;
+   } // for
+
+   out << static_cast<qint32>(store.services().count() );
+   for (int i = 0; i < store.services().count(); ++i) {
+      out << store.services().at(i).objpath.path() << streamable(store.services().at(i).toMap() );
+   } // for
+
+   out << static_cast<qint32>(store.vpnConnections().count() );
+   for (int i = 0; i < store.vpnConnections().count(); ++i) {
+      out << store.vpnConnections().at(i).objpath.path() << streamable(store.vpnConnections().at(i).objmap);
+   } // for
+
+   return bytes;
+}
+
+//
+// Functions to make a value safe for QDataStream.  Dictionaries still
+// wrapped in a QDBusArgument are decoded, object paths become strings and
+// anything else QDataStream can't write is dropped.
+QVariant StoreSnapshot::streamable(const QVariant& var)
+{
+   if (var.userType() == qMetaTypeId<QDBusObjectPath>() ) return QVariant(var.value<QDBusObjectPath>().path() );
+
+   if (var.userType() == QMetaType::QVariantMap || var.userType() == qMetaTypeId<QDBusArgument>() ) {
+      QMap<QString,QVariant> map;
+      if (! shared::extractMapData(map, var) ) return QVariant();
+      return QVariant(streamable(map) );
+   } // if a dictionary
+
+   if (var.userType() >= QMetaType::User) return QVariant();
+
+   return var;
+}
+
+QMap<QString,QVariant> StoreSnapshot::streamable(const QMap<QString,QVariant>& map)
+{
+   QMap<QString,QVariant> rtn;
+   QMapIterator<QString,QVariant> itr(map);
+   while (itr.hasNext()) {
+      itr.next();
+      const QVariant var = streamable(itr.value() );
+      if (var.isValid() ) rtn.insert(itr.key(), var);
+   } // while
+
+   return rtn;
+}
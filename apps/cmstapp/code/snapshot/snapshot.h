@@ -0,0 +1,60 @@
+/**************************** snapshot.h *****************************
+
+Snapshot of the store written to the cache directory so the last known
+state can be shown the moment the program starts, before connman has
+answered any of the startup queries.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef STORE_SNAPSHOT_H
+# define STORE_SNAPSHOT_H
+
+# include <QString>
+# include <QByteArray>
+# include <QVariant>
+# include <QMap>
+
+# include "./code/store/store.h"
+
+class StoreSnapshot
+{
+   public:
+      StoreSnapshot();
+
+      bool load(ConnmanStore&);
+      bool save(const ConnmanStore&);
+      inline const QString& fileName() const {return filename;}
+
+   private:
+      // members
+      QString filename;
+      QByteArray written;     // contents of the last save, an unchanged store is not written again
+
+      // functions
+      QByteArray serialize(const ConnmanStore&) const;
+      static QVariant streamable(const QVariant&);
+      static QMap<QString,QVariant> streamable(const QMap<QString,QVariant>&);
+};
+
+# endif
@@ -0,0 +1,499 @@
+/**************************** records.cpp ****************************
+
+Typed records for the connman services and technologies.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QMapIterator>
+# include <QtDBus/QDBusMetaType>
+
+# include "./records.h"
+# include "./code/shared/shared.h"
+
+// The strings connman uses, in enum order
+namespace
+{
+   const char* const type_strings[] = {
+      "", "system", "ethernet", "wifi", "bluetooth", "cellular", "gps", "vpn", "gadget", "p2p"
+   };
+   const int type_count = sizeof(type_strings) / sizeof(type_strings[0]);
+
+   const char* const state_strings[] = {
+      "", "idle", "failure", "association", "configuration", "ready", "disconnect", "online"
+   };
+   const int state_count = sizeof(state_strings) / sizeof(state_strings[0]);
+
+   // in the same order as the Sec_ flags
+   const char* const security_strings[] = {
+      "none", "wep", "psk", "ieee8021x", "wps", "wps_advertising"
+   };
+   const int security_count = sizeof(security_strings) / sizeof(security_strings[0]);
+
+   // The service properties we decode, in the order of the bits in
+   // ServiceRecord::props
+   enum ServiceProperty {
+      SP_State, SP_Type, SP_Name, SP_Strength, SP_Security, SP_Favorite,
+      SP_Immutable, SP_AutoConnect, SP_Roaming, SP_Error, SP_IPv4, SP_IPv6,
+      SP_Proxy, SP_Ethernet, SP_Provider, SP_IPv4Config, SP_IPv6Config,
+      SP_ProxyConfig, SP_LastAddressConflict, SP_Nameservers, SP_Timeservers,
+      SP_Domains, SP_NameserversConfig, SP_TimeserversConfig, SP_DomainsConfig,
+      SP_mDNS, SP_mDNSConfig
+   };
+   const char* const service_properties[] = {
+      "State", "Type", "Name", "Strength", "Security", "Favorite",
+      "Immutable", "AutoConnect", "Roaming", "Error", "IPv4", "IPv6",
+      "Proxy", "Ethernet", "Provider", "IPv4.Configuration", "IPv6.Configuration",
+      "Proxy.Configuration", "LastAddressConflict", "Nameservers", "Timeservers",
+      "Domains", "Nameservers.Configuration", "Timeservers.Configuration", "Domains.Configuration",
+      "mDNS", "mDNS.Configuration"
+   };
+   const int service_property_count = sizeof(service_properties) / sizeof(service_properties[0]);
+
+   // The same for the technology properties and TechnologyRecord::props
+   enum TechnologyProperty {
+      TP_Powered, TP_Connected, TP_Name, TP_Type, TP_Tethering,
+      TP_TetheringIdentifier, TP_TetheringPassphrase
+   };
+   const char* const technology_properties[] = {
+      "Powered", "Connected", "Name", "Type", "Tethering",
+      "TetheringIdentifier", "TetheringPassphrase"
+   };
+   const int technology_property_count = sizeof(technology_properties) / sizeof(technology_properties[0]);
+
+   //
+   // Function to return the index of s in the table strings, or -1 if it
+   // is not there
+   int indexOf(const char* const strings[], int count, const QString& s)
+   {
+      for (int i = 0; i < count; ++i) {
+         if (s == QLatin1String(strings[i]) ) return i;
+      } // for
+
+      return -1;
+   }
+
+   //
+   // Functions to decode a dictionary and any dictionaries nested inside
+   // it into plain QVariantMaps.  Each nested dictionary is extracted once
+   // and the extracted map is decoded in place.  decodeMap() returns an
+   // empty map if var does not hold a dictionary.
+   void decodeNested(QMap<QString,QVariant>& r_map)
+   {
+      QMutableMapIterator<QString,QVariant> itr(r_map);
+      while (itr.hasNext()) {
+         itr.next();
+         if (itr.value().userType() == qMetaTypeId<QDBusArgument>() ) {
+            QMap<QString,QVariant> submap;
+            if (shared::extractMapData(submap, itr.value()) ) {
+               decodeNested(submap);
+               itr.setValue(QVariant(submap) );
+            } // if a dictionary
+         } // if
+      } // while
+
+      return;
+   }
+
+   QMap<QString,QVariant> decodeMap(const QVariant& var)
+   {
+      QMap<QString,QVariant> map;
+      if (shared::extractMapData(map, var) ) decodeNested(map);
+
+      return map;
+   }
+
+   //
+   // Function to read a dictionary from argument one entry at a time and
+   // pass each property to rec.setProperty().  Nested dictionaries are
+   // decoded there, so each one is only walked once.  Return the number
+   // of properties read.
+   template <class T> int readDict(const QDBusArgument& argument, T& rec)
+   {
+      int count = 0;
+      argument.beginMap();
+      while (! argument.atEnd() ) {
+         QString key;
+         QDBusVariant value;
+         argument.beginMapEntry();
+         argument >> key >> value;
+         argument.endMapEntry();
+         rec.setProperty(key, value.variant() );
+         ++count;
+      } // while
+      argument.endMap();
+
+      return count;
+   }
+} // namespace
+
+////////////////////////////////////////////////// arrayElement //////////////////////////////////////
+//
+// Functions to marshall and demarshall an arrayElement
+QDBusArgument& operator<<(QDBusArgument& argument, const arrayElement& ae)
+{
+   argument.beginStructure();
+   argument << ae.objpath << ae.objmap;
+   argument.endStructure();
+
+   return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, arrayElement& ae)
+{
+   argument.beginStructure();
+   argument >> ae.objpath >> ae.objmap;
+   argument.endStructure();
+
+   return argument;
+}
+
+//
+// Functions to marshall and demarshall the records as (oa{sv})
+QDBusArgument& operator<<(QDBusArgument& argument, const ServiceRecord& rec)
+{
+   argument.beginStructure();
+   argument << rec.objpath << rec.toMap();
+   argument.endStructure();
+
+   return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, ServiceRecord& rec)
+{
+   rec = ServiceRecord();
+   argument.beginStructure();
+   argument >> rec.objpath;
+   rec.readProperties(argument);
+   argument.endStructure();
+
+   return argument;
+}
+
+QDBusArgument& operator<<(QDBusArgument& argument, const TechnologyRecord& rec)
+{
+   argument.beginStructure();
+   argument << rec.objpath << rec.toMap();
+   argument.endStructure();
+
+   return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, TechnologyRecord& rec)
+{
+   rec = TechnologyRecord();
+   argument.beginStructure();
+   argument >> rec.objpath;
+   rec.readProperties(argument);
+   argument.endStructure();
+
+   return argument;
+}
+
+//
+// Function to register the types the generated proxies return with
+// QtDBus.  Must be called before the first call is sent.
+void registerRecordTypes()
+{
+   qDBusRegisterMetaType<arrayElement>();
+   qDBusRegisterMetaType<QList<arrayElement> >();
+   qDBusRegisterMetaType<ServiceRecord>();
+   qDBusRegisterMetaType<QList<ServiceRecord> >();
+   qDBusRegisterMetaType<TechnologyRecord>();
+   qDBusRegisterMetaType<QList<TechnologyRecord> >();
+
+   return;
+}
+
+////////////////////////////////////////////////// ServiceRecord /////////////////////////////////////
+//
+// constructor
+ServiceRecord::ServiceRecord()
+{
+   type = Type_Unknown;
+   state = State_Unknown;
+   security = 0x00;
+   strength = -1;
+   favorite = false;
+   immutable = false;
+   autoconnect = false;
+   roaming = false;
+   mdns = false;
+   mdnsconfig = false;
+   props = 0;
+}
+
+//
+// Function to decode a single property into the record.  Called for each
+// property when a service arrives and from the PropertyChanged signal.
+void ServiceRecord::setProperty(const QString& key, const QVariant& value)
+{
+   const int prop = indexOf(service_properties, service_property_count, key);
+   if (prop < 0) {
+      extra.insert(key, value);
+      return;
+   }
+   props |= (1 << prop);
+
+   switch (prop) {
+      case SP_State: state = stateFromString(value.toString() ); break;
+      case SP_Type: type = typeFromString(value.toString() ); break;
+      case SP_Name: name = value.toString(); break;
+      case SP_Strength: strength = value.value<quint8>(); break;
+      case SP_Security: {
+         const QStringList sl = value.toStringList();
+         security = securityFromStrings(sl);
+         securityother.clear();
+         for (int i = 0; i < sl.size(); ++i) {
+            if (indexOf(security_strings, security_count, sl.at(i)) < 0) securityother << sl.at(i);
+         } // for
+         break; }
+      case SP_Favorite: favorite = value.toBool(); break;
+      case SP_Immutable: immutable = value.toBool(); break;
+      case SP_AutoConnect: autoconnect = value.toBool(); break;
+      case SP_Roaming: roaming = value.toBool(); break;
+      case SP_Error: error = value.toString(); break;
+      case SP_IPv4: ipv4 = decodeMap(value); break;
+      case SP_IPv6: ipv6 = decodeMap(value); break;
+      case SP_Proxy: proxy = decodeMap(value); break;
+      case SP_Ethernet: ethernet = decodeMap(value); break;
+      case SP_Provider: provider = decodeMap(value); break;
+      case SP_IPv4Config: ipv4config = decodeMap(value); break;
+      case SP_IPv6Config: ipv6config = decodeMap(value); break;
+      case SP_ProxyConfig: proxyconfig = decodeMap(value); break;
+      case SP_LastAddressConflict: lastaddressconflict = decodeMap(value); break;
+      case SP_Nameservers: nameservers = value.toStringList(); break;
+      case SP_Timeservers: timeservers = value.toStringList(); break;
+      case SP_Domains: domains = value.toStringList(); break;
+      case SP_NameserversConfig: nameserversconfig = value.toStringList(); break;
+      case SP_TimeserversConfig: timeserversconfig = value.toStringList(); break;
+      case SP_DomainsConfig: domainsconfig = value.toStringList(); break;
+      case SP_mDNS: mdns = value.toBool(); break;
+      case SP_mDNSConfig: mdnsconfig = value.toBool(); break;
+      default: break;
+   } // switch
+
+   return;
+}
+
+//
+// Function to read an a{sv} dictionary of properties from a DBus argument
+// into the record.  Properties not in the dictionary are left alone.
+// Return the number of properties read.
+int ServiceRecord::readProperties(const QDBusArgument& argument)
+{
+   return readDict(argument, *this);
+}
+
+//
+// Function to materialise the record back into a property map. Only the
+// properties connman sent are included.  Nested dictionaries are returned
+// as QVariantMaps.
+QMap<QString,QVariant> ServiceRecord::toMap() const
+{
+   QMap<QString,QVariant> map = extra;
+
+   for (int prop = 0; prop < service_property_count; ++prop) {
+      if (! (props & (1 << prop)) ) continue;
+      QVariant var;
+      switch (prop) {
+         case SP_State: var = stateString(); break;
+         case SP_Type: var = typeString(); break;
+         case SP_Name: var = name; break;
+         case SP_Strength: var = QVariant::fromValue<quint8>(strength); break;
+         case SP_Security: var = securityStrings(); break;
+         case SP_Favorite: var = favorite; break;
+         case SP_Immutable: var = immutable; break;
+         case SP_AutoConnect: var = autoconnect; break;
+         case SP_Roaming: var = roaming; break;
+         case SP_Error: var = error; break;
+         case SP_IPv4: var = ipv4; break;
+         case SP_IPv6: var = ipv6; break;
+         case SP_Proxy: var = proxy; break;
+         case SP_Ethernet: var = ethernet; break;
+         case SP_Provider: var = provider; break;
+         case SP_IPv4Config: var = ipv4config; break;
+         case SP_IPv6Config: var = ipv6config; break;
+         case SP_ProxyConfig: var = proxyconfig; break;
+         case SP_LastAddressConflict: var = lastaddressconflict; break;
+         case SP_Nameservers: var = nameservers; break;
+         case SP_Timeservers: var = timeservers; break;
+         case SP_Domains: var = domains; break;
+         case SP_NameserversConfig: var = nameserversconfig; break;
+         case SP_TimeserversConfig: var = timeserversconfig; break;
+         case SP_DomainsConfig: var = domainsconfig; break;
+         case SP_mDNS: var = mdns; break;
+         case SP_mDNSConfig: var = mdnsconfig; break;
+         default: break;
+      } // switch
+      map.insert(QString(service_properties[prop]), var);
+   } // for
+
+   return map;
+}
+
+//
+// Function to return the security flags as the strings connman uses
+QStringList ServiceRecord::securityStrings() const
+{
+   QStringList sl;
+   for (int i = 0; i < security_count; ++i) {
+      if (security & (1 << i)) sl << QString(security_strings[i]);
+   } // for
+   sl << securityother;
+
+   return sl;
+}
+
+//
+// Functions to convert between the connman strings and our enums
+ServiceRecord::Type ServiceRecord::typeFromString(const QString& s)
+{
+   for (int i = 1; i < type_count; ++i) {
+      if (s == QLatin1String(type_strings[i]) ) return static_cast<Type>(i);
+   } // for
+
+   return Type_Unknown;
+}
+
+QString ServiceRecord::typeToString(Type t)
+{
+   return QString(type_strings[t]);
+}
+
+ServiceRecord::State ServiceRecord::stateFromString(const QString& s)
+{
+   for (int i = 1; i < state_count; ++i) {
+      if (s == QLatin1String(state_strings[i]) ) return static_cast<State>(i);
+   } // for
+
+   return State_Unknown;
+}
+
+QString ServiceRecord::stateToString(State s)
+{
+   return QString(state_strings[s]);
+}
+
+quint8 ServiceRecord::securityFromStrings(const QStringList& sl)
+{
+   quint8 flags = 0x00;
+   for (int i = 0; i < sl.size(); ++i) {
+      int j = 0;
+      for (; j < security_count; ++j) {
+         if (sl.at(i) == QLatin1String(security_strings[j]) ) {
+            flags |= (1 << j);
+            break;
+         } // if
+      } // j for
+      if (j == security_count) flags |= Sec_Unknown;
+   } // i for
+
+   return flags;
+}
+
+////////////////////////////////////////////////// TechnologyRecord //////////////////////////////////
+//
+// constructor
+TechnologyRecord::TechnologyRecord()
+{
+   type = ServiceRecord::Type_Unknown;
+   powered = false;
+   connected = false;
+   tethering = false;
+   props = 0;
+}
+
+//
+// Function to decode an arrayElement received from connman into a record
+TechnologyRecord TechnologyRecord::fromElement(const arrayElement& ae)
+{
+   TechnologyRecord rec;
+   rec.objpath = ae.objpath;
+
+   QMapIterator<QString,QVariant> itr(ae.objmap);
+   while (itr.hasNext()) {
+      itr.next();
+      rec.setProperty(itr.key(), itr.value() );
+   } // while
+
+   return rec;
+}
+
+//
+// Function to decode a single property into the record
+void TechnologyRecord::setProperty(const QString& key, const QVariant& value)
+{
+   const int prop = indexOf(technology_properties, technology_property_count, key);
+   if (prop < 0) {
+      extra.insert(key, value);
+      return;
+   }
+   props |= (1 << prop);
+
+   switch (prop) {
+      case TP_Powered: powered = value.toBool(); break;
+      case TP_Connected: connected = value.toBool(); break;
+      case TP_Name: name = value.toString(); break;
+      case TP_Type: type = ServiceRecord::typeFromString(value.toString() ); break;
+      case TP_Tethering: tethering = value.toBool(); break;
+      case TP_TetheringIdentifier: tetheringidentifier = value.toString(); break;
+      case TP_TetheringPassphrase: tetheringpassphrase = value.toString(); break;
+      default: break;
+   } // switch
+
+   return;
+}
+
+//
+// Function to read an a{sv} dictionary of properties into the record
+int TechnologyRecord::readProperties(const QDBusArgument& argument)
+{
+   return readDict(argument, *this);
+}
+
+//
+// Function to materialise the record back into a property map.  Only the
+// properties connman sent are included.
+QMap<QString,QVariant> TechnologyRecord::toMap() const
+{
+   QMap<QString,QVariant> map = extra;
+
+   for (int prop = 0; prop < technology_property_count; ++prop) {
+      if (! (props & (1 << prop)) ) continue;
+      QVariant var;
+      switch (prop) {
+         case TP_Powered: var = powered; break;
+         case TP_Connected: var = connected; break;
+         case TP_Name: var = name; break;
+         case TP_Type: var = ServiceRecord::typeToString(type); break;
+         case TP_Tethering: var = tethering; break;
+         case TP_TetheringIdentifier: var = tetheringidentifier; break;
+         case TP_TetheringPassphrase: var = tetheringpassphrase; break;
+         default: break;
+      } // switch
+      map.insert(QString(technology_properties[prop]), var);
+   } // for
+
+   return map;
+}
@@ -0,0 +1,180 @@
+/**************************** records.h ******************************
+
+Typed records for the connman services and technologies. Connman sends
+objects as a{sv} dictionaries.  We decode the dictionary once when it
+arrives so the display code can compare enums and read integers instead
+of looking up and converting QVariants on every redraw.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CONNMAN_RECORDS_H
+# define CONNMAN_RECORDS_H
+
+# include <QtDBus/QDBusObjectPath>
+# include <QtDBus/QDBusArgument>
+# include <QMetaType>
+# include <QString>
+# include <QStringList>
+# include <QMap>
+# include <QVariant>
+
+// Two of the connman.Manager query functions will return an array of structures.
+// This struct provides a receiving element we can use to collect the return data.
+struct arrayElement
+{
+   QDBusObjectPath objpath;
+   QMap<QString,QVariant> objmap;
+};
+Q_DECLARE_METATYPE(arrayElement)
+
+// Marshalling for the generated connman proxies, the (oa{sv}) structure
+QDBusArgument& operator<<(QDBusArgument&, const arrayElement&);
+const QDBusArgument& operator>>(const QDBusArgument&, arrayElement&);
+void registerRecordTypes();
+
+//
+// A connman service.  Properties we use are decoded into members, any
+// property we don't know about is kept in extra so nothing is lost.
+struct ServiceRecord
+{
+   enum Type {
+      Type_Unknown   = 0x00,
+      Type_System    = 0x01,
+      Type_Ethernet  = 0x02,
+      Type_Wifi      = 0x03,
+      Type_Bluetooth = 0x04,
+      Type_Cellular  = 0x05,
+      Type_GPS       = 0x06,
+      Type_VPN       = 0x07,
+      Type_Gadget    = 0x08,
+      Type_P2P       = 0x09,
+   };
+
+   enum State {
+      State_Unknown       = 0x00,
+      State_Idle          = 0x01,
+      State_Failure       = 0x02,
+      State_Association   = 0x03,
+      State_Configuration = 0x04,
+      State_Ready         = 0x05,
+      State_Disconnect    = 0x06,
+      State_Online        = 0x07,
+   };
+
+   // security is a list in connman, keep it as flags
+   enum Security {
+      Sec_None           = (1 << 0),
+      Sec_WEP            = (1 << 1),
+      Sec_PSK            = (1 << 2),
+      Sec_IEEE8021x      = (1 << 3),
+      Sec_WPS            = (1 << 4),
+      Sec_WPSAdvertising = (1 << 5),
+      Sec_Unknown        = (1 << 7),
+   };
+
+   ServiceRecord();
+   void setProperty(const QString&, const QVariant&);
+   int readProperties(const QDBusArgument&);
+   QMap<QString,QVariant> toMap() const;
+
+   inline bool isConnected() const {return state == State_Ready || state == State_Online;}
+   inline QString typeString() const {return typeToString(type);}
+   inline QString stateString() const {return stateToString(state);}
+   QStringList securityStrings() const;
+
+   static Type typeFromString(const QString&);
+   static QString typeToString(Type);
+   static State stateFromString(const QString&);
+   static QString stateToString(State);
+   static quint8 securityFromStrings(const QStringList&);
+
+   // members
+   QDBusObjectPath objpath;
+   Type type;
+   State state;
+   quint8 security;
+   qint16 strength;                 // -1 if connman did not send one
+   bool favorite;
+   bool immutable;
+   bool autoconnect;
+   bool roaming;
+   bool mdns;
+   QString name;
+   QString error;
+   QStringList securityother;       // security strings we have no flag for
+   QStringList nameservers;
+   QStringList timeservers;
+   QStringList domains;
+   QMap<QString,QVariant> ipv4;
+   QMap<QString,QVariant> ipv6;
+   QMap<QString,QVariant> proxy;
+   QMap<QString,QVariant> ethernet;
+   QMap<QString,QVariant> provider;
+   QMap<QString,QVariant> ipv4config;
+   QMap<QString,QVariant> ipv6config;
+   QMap<QString,QVariant> proxyconfig;
+   QMap<QString,QVariant> lastaddressconflict;
+   QStringList nameserversconfig;
+   QStringList timeserversconfig;
+   QStringList domainsconfig;
+   bool mdnsconfig;
+   quint32 props;                   // one bit for each property connman sent
+   QMap<QString,QVariant> extra;    // properties we don't decode
+};
+
+//
+// A connman technology
+struct TechnologyRecord
+{
+   TechnologyRecord();
+   static TechnologyRecord fromElement(const arrayElement&);
+   void setProperty(const QString&, const QVariant&);
+   int readProperties(const QDBusArgument&);
+   QMap<QString,QVariant> toMap() const;
+
+   inline QString typeString() const {return ServiceRecord::typeToString(type);}
+
+   // members
+   QDBusObjectPath objpath;
+   ServiceRecord::Type type;
+   QString name;
+   bool powered;
+   bool connected;
+   bool tethering;
+   QString tetheringidentifier;
+   QString tetheringpassphrase;
+   quint8 props;                    // one bit for each property connman sent
+   QMap<QString,QVariant> extra;    // properties we don't decode
+};
+Q_DECLARE_METATYPE(ServiceRecord)
+Q_DECLARE_METATYPE(TechnologyRecord)
+
+// Marshalling for the generated connman proxies.  Replies are decoded
+// straight into the records, without building an arrayElement first.
+QDBusArgument& operator<<(QDBusArgument&, const ServiceRecord&);
+const QDBusArgument& operator>>(const QDBusArgument&, ServiceRecord&);
+QDBusArgument& operator<<(QDBusArgument&, const TechnologyRecord&);
+const QDBusArgument& operator>>(const QDBusArgument&, TechnologyRecord&);
+
+# endif
@@ -0,0 +1,282 @@
+/**************************** store.cpp ******************************
+
+Class to hold the objects (services, technologies, peers and vpn
+connections) we receive from connman.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QCoreApplication>
+# include <QMapIterator>
+
+# include "./store.h"
+# include "./code/trstring/tr_strings.h"
+
+// constructor
+ConnmanStore::ConnmanStore()
+{
+   properties_map.clear();
+   technologies_list.clear();
+   services_list.clear();
+   peer_list.clear();
+   vpnconn_list.clear();
+   wifi_rows.clear();
+   vpn_rows.clear();
+   nick_names.clear();
+}
+
+////////////////////////////////////////////////// Public Functions //////////////////////////////////
+//
+// Function to empty the store
+void ConnmanStore::clear()
+{
+   properties_map.clear();
+   technologies_list.clear();
+   services_list.clear();
+   peer_list.clear();
+   vpnconn_list.clear();
+   wifi_rows.clear();
+   vpn_rows.clear();
+   nick_names.clear();
+
+   return;
+}
+
+//
+// Function to replace a single property of a technology. Return false if
+// we don't know the technology.
+bool ConnmanStore::setTechnologyProperty(const QString& path, const QString& prop, const QVariant& value)
+{
+   TechnologyRecord* rec = technologies_list.find(path);
+   if (rec == NULL) return false;
+
+   rec->setProperty(prop, value);
+
+   return true;
+}
+
+//
+// Function to replace the technologies list with the reply from
+// connman.Manager.GetTechnologies
+void ConnmanStore::setTechnologies(const QList<TechnologyRecord>& list)
+{
+   technologies_list.assign(list);
+
+   return;
+}
+
+//
+// Function to replace the services list, for instance with the reply from
+// connman.Manager.GetServices
+void ConnmanStore::setServices(const QList<ServiceRecord>& list)
+{
+   services_list.assign(list);
+   reindexServices();
+
+   return;
+}
+
+//
+// Function to replace the services list with the reply from
+// connman.Manager.GetServices and record what changed in r_changes.
+// Every service in the reply carries all of its properties, so every
+// service we already had counts as changed.
+void ConnmanStore::replaceServices(const QList<ServiceRecord>& list, ChangeSet& r_changes)
+{
+   ObjectList<ServiceRecord> replaced;
+   replaced.reserve(list.size());
+
+   for (int i = 0; i < list.size(); ++i) {
+      const QString path = list.at(i).objpath.path();
+      if (services_list.contains(path) ) r_changes.changed.append(path);
+         else r_changes.inserted.append(path);
+      replaced.append(list.at(i));
+   } // for
+
+   finishMerge(services_list, replaced, r_changes);
+   services_list = replaced;
+   reindexServices();
+
+   return;
+}
+
+//
+// Function to merge the array received with a ServicesChanged signal into
+// the services list.  The array contains every service in the current sort
+// order, services we already know about only carry the properties that
+// changed.  The array is read straight from the DBus argument, the
+// changed properties are decoded into the records as they are read.
+// Each service is looked up by path, so the whole merge is linear in the
+// number of services.  What changed is added to r_changes.
+//
+// Return false if the argument is not an a(oa{sv}) array, in which case
+// the store is not changed.
+bool ConnmanStore::mergeServices(const QDBusArgument& argument, ChangeSet& r_changes)
+{
+   if (argument.currentType() != QDBusArgument::ArrayType) return false;
+
+   ObjectList<ServiceRecord> merged;
+   merged.reserve(services_list.size());
+
+   argument.beginArray();
+   while (! argument.atEnd() ) {
+      if (argument.currentType() != QDBusArgument::StructureType) return false;
+
+      QDBusObjectPath objpath;
+      argument.beginStructure();
+      argument >> objpath;
+      const ServiceRecord* original = services_list.find(objpath.path() );
+      ServiceRecord rec;
+      if (original != NULL) rec = *original;
+      else rec.objpath = objpath;
+      const int count = rec.readProperties(argument);
+      argument.endStructure();
+      if (original == NULL) r_changes.inserted.append(objpath.path() );
+         else if (count > 0) r_changes.changed.append(objpath.path() );
+      merged.append(rec);
+   } // while
+   argument.endArray();
+
+   finishMerge(services_list, merged, r_changes);
+   services_list = merged;
+   reindexServices();
+
+   return true;
+}
+
+//
+// Function to remove services, return the number of services removed
+int ConnmanStore::removeServices(const QList<QDBusObjectPath>& paths, ChangeSet& r_changes)
+{
+   const int removed = remove(services_list, paths, r_changes);
+   if (removed > 0) reindexServices();
+
+   return removed;
+}
+
+//
+// Function to replace a single property of a service.  Return false if we
+// don't know the service.
+bool ConnmanStore::setServiceProperty(const QString& path, const QString& prop, const QVariant& value)
+{
+   ServiceRecord* rec = services_list.find(path);
+   if (rec == NULL) return false;
+
+   rec->setProperty(prop, value);
+
+   // the nick name is built from these properties
+   if (prop == "Name" || prop == "Type" || prop == "Ethernet")
+      nick_names.insert(path, makeNickName(*rec) );
+
+   return true;
+}
+
+//
+// Function to merge the array received with a PeersChanged signal into the
+// peer list.
+void ConnmanStore::mergePeers(const QList<arrayElement>& revised, ChangeSet& r_changes)
+{
+   merge(peer_list, revised, r_changes);
+
+   return;
+}
+
+//
+// Function to remove peers, return the number of peers removed
+int ConnmanStore::removePeers(const QList<QDBusObjectPath>& paths, ChangeSet& r_changes)
+{
+   return remove(peer_list, paths, r_changes);
+}
+
+////////////////////////////////////////////////// Private Functions /////////////////////////////////
+//
+// Function to rebuild the wifi and vpn row indexes and the nick names.
+// Needs to be called whenever the services list is rebuilt or reordered.
+void ConnmanStore::reindexServices()
+{
+   wifi_rows.clear();
+   vpn_rows.clear();
+   nick_names.clear();
+
+   for (int row = 0; row < services_list.size(); ++row) {
+      const ServiceRecord& rec = services_list.at(row);
+      if (rec.type == ServiceRecord::Type_Wifi) wifi_rows.append(row);
+         else if (rec.type == ServiceRecord::Type_VPN) vpn_rows.append(row);
+      nick_names.insert(rec.objpath.path(), makeNickName(rec) );
+   } // for
+
+   return;
+}
+
+//
+// Function to create a nick name for a service. Typically this is the Name
+// property.  For wired ethernet Name comes back as Wired, and for hidden
+// wifi networks this is blank. In those cases create a nickname.
+QString ConnmanStore::makeNickName(const ServiceRecord& rec) const
+{
+   if (rec.type == ServiceRecord::Type_Ethernet) {
+      const QString iface = rec.ethernet.value("Interface").toString();
+      if (iface.isEmpty() )
+         return rec.name;
+      else
+         return QString(TranslateStrings::cmtr(rec.name) + " [%1]").arg(iface);
+   } // if type ethernet
+
+   if (rec.type == ServiceRecord::Type_Wifi && rec.name.isEmpty() )
+      return QCoreApplication::translate("ControlBox", "[Hidden Wifi]");
+
+   return rec.name;
+}
+
+//
+// Function to merge a revised array into an existing peer list. The revised array
+// becomes the new list, but elements we already had keep their properties
+// with the revised ones merged on top.  What changed is added to r_changes.
+void ConnmanStore::merge(ObjectList<arrayElement>& list, const QList<arrayElement>& revised, ChangeSet& r_changes)
+{
+   ObjectList<arrayElement> merged;
+   merged.reserve(revised.size());
+
+   for (int i = 0; i < revised.size(); ++i) {
+      const arrayElement* original = list.find(revised.at(i).objpath.path() );
+      if (original == NULL) {
+         merged.append(revised.at(i));
+         r_changes.inserted.append(revised.at(i).objpath.path() );
+      }
+      else {
+         if (! revised.at(i).objmap.isEmpty() ) r_changes.changed.append(revised.at(i).objpath.path() );
+         arrayElement ae = *original;
+         QMapIterator<QString, QVariant> itr(revised.at(i).objmap);
+         while (itr.hasNext()) {
+            itr.next();
+            ae.objmap.insert(itr.key(), itr.value() );
+         } // while
+         merged.append(ae);
+      } // else
+   } // for
+
+   finishMerge(list, merged, r_changes);
+   list = merged;
+
+   return;
+}
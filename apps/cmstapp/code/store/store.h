@@ -0,0 +1,285 @@
+/**************************** store.h ********************************
+
+Class to hold the objects (services, technologies, peers and vpn
+connections) we receive from connman.  Objects are indexed by their DBus
+object path so lookups from signal handlers are a hash lookup, and the
+order connman reports them in is kept separately.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef CONNMAN_STORE_H
+# define CONNMAN_STORE_H
+
+# include <QtDBus/QDBusObjectPath>
+# include <QString>
+# include <QMap>
+# include <QHash>
+# include <QVector>
+# include <QList>
+# include <QVariant>
+# include <QtDBus/QDBusArgument>
+
+# include "./records.h"
+
+//
+// An ordered list of elements keyed by object path.  Elements live in a hash
+// so finding one from a signal is O(1).  The order connman sent them in is a
+// vector of keys, and a second hash maps a key back to its row.  T must have
+// a QDBusObjectPath objpath member.
+template <class T>
+class ObjectList
+{
+   public:
+      inline int count() const {return order.size();}
+      inline int size() const {return order.size();}
+      inline bool isEmpty() const {return order.isEmpty();}
+      inline const T& at(int row) const {return elements.constFind(order.at(row)).value();}
+      inline bool contains(const QString& path) const {return elements.contains(path);}
+      inline bool contains(const QDBusObjectPath& path) const {return elements.contains(path.path());}
+      inline int indexOf(const QString& path) const {return rows.value(path, -1);}
+      inline int indexOf(const QDBusObjectPath& path) const {return rows.value(path.path(), -1);}
+      inline const QVector<QString>& keys() const {return order;}
+      inline void reserve(int n) {elements.reserve(n); order.reserve(n); rows.reserve(n);}
+      inline void clear() {elements.clear(); order.clear(); rows.clear();}
+
+      // Return a pointer to the element at path, NULL if there isn't one.  The
+      // pointer is only good until the list is next modified.
+      inline const T* find(const QString& path) const {
+         typename QHash<QString,T>::const_iterator itr = elements.constFind(path);
+         return itr == elements.constEnd() ? NULL : &itr.value(); }
+      inline T* find(const QString& path) {
+         typename QHash<QString,T>::iterator itr = elements.find(path);
+         return itr == elements.end() ? NULL : &itr.value(); }
+
+      // Add an element to the end of the list, or replace it in place if
+      // we already have one with the same path.
+      void append(const T& t) {
+         const QString key = t.objpath.path();
+         if (! elements.contains(key) ) {
+            rows.insert(key, order.size());
+            order.append(key);
+         }
+         elements.insert(key, t);
+         return; }
+
+      // Replace the entire list
+      void assign(const QList<T>& list) {
+         clear();
+         reserve(list.size());
+         for (int i = 0; i < list.size(); ++i) {
+            append(list.at(i));
+         }
+         return; }
+
+      // Remove one element, return true if it was found
+      bool remove(const QString& path) {
+         if (elements.remove(path) == 0) return false;
+         const int row = rows.take(path);
+         order.remove(row);
+         reindex(row);
+         return true; }
+
+      // Remove several elements in a single pass, return the number removed
+      int remove(const QList<QDBusObjectPath>& paths) {
+         int removed = 0;
+         for (int i = 0; i < paths.size(); ++i) {
+            if (elements.remove(paths.at(i).path()) > 0) ++removed;
+         }
+         if (removed == 0) return 0;
+         QVector<QString> kept;
+         kept.reserve(elements.size());
+         for (int i = 0; i < order.size(); ++i) {
+            if (elements.contains(order.at(i)) ) kept.append(order.at(i));
+         }
+         order = kept;
+         rows.clear();
+         reindex(0);
+         return removed; }
+
+   private:
+      QHash<QString,T> elements;
+      QVector<QString> order;
+      QHash<QString,int> rows;
+
+      inline void reindex(int from) {
+         for (int i = from; i < order.size(); ++i) {
+            rows.insert(order.at(i), i);
+         }
+         return; }
+};
+
+//
+// What a merge or a removal did to a list, by object path.  Filled in by
+// the store so callers can tell if anything they show needs redrawing,
+// and so the models only look at the rows that were reported.
+struct ChangeSet
+{
+   // an object we kept that is on a different row
+   struct Move
+   {
+      QString path;
+      int from;                  // row in the old list
+      int to;                    // row in the new list
+   };
+
+   inline bool isEmpty() const {return inserted.isEmpty() && changed.isEmpty() && removed.isEmpty() && moved.isEmpty();}
+   inline bool isReordered() const {return ! (inserted.isEmpty() && removed.isEmpty() && moved.isEmpty());}
+
+   QVector<QString> inserted;    // objects we did not have before
+   QVector<QString> changed;     // objects that had properties changed
+   QVector<QString> removed;     // objects that are gone
+   QVector<Move> moved;          // the fewest kept objects that explain the new order
+};
+
+//
+// The store itself.  ControlBox owns one of these and every consumer
+// reads connman objects through it.
+class ConnmanStore
+{
+   public:
+      ConnmanStore();
+      void clear();
+
+      // manager properties
+      inline const QMap<QString,QVariant>& properties() const {return properties_map;}
+      inline void setProperties(const QMap<QString,QVariant>& map) {properties_map = map;}
+      inline void setProperty(const QString& key, const QVariant& value) {properties_map.insert(key, value);}
+
+      // technologies
+      inline const ObjectList<TechnologyRecord>& technologies() const {return technologies_list;}
+      void setTechnologies(const QList<TechnologyRecord>&);
+      inline void addTechnology(const arrayElement& ae) {technologies_list.append(TechnologyRecord::fromElement(ae));}
+      inline bool removeTechnology(const QDBusObjectPath& path) {return technologies_list.remove(path.path());}
+      bool setTechnologyProperty(const QString&, const QString&, const QVariant&);
+
+      // services, plus the wifi and vpn views of them
+      inline const ObjectList<ServiceRecord>& services() const {return services_list;}
+      void setServices(const QList<ServiceRecord>&);
+      void replaceServices(const QList<ServiceRecord>&, ChangeSet&);
+      bool mergeServices(const QDBusArgument&, ChangeSet&);
+      int removeServices(const QList<QDBusObjectPath>&, ChangeSet&);
+      bool setServiceProperty(const QString&, const QString&, const QVariant&);
+      inline int wifiCount() const {return wifi_rows.size();}
+      inline const ServiceRecord& wifiAt(int i) const {return services_list.at(wifi_rows.at(i));}
+      inline int vpnCount() const {return vpn_rows.size();}
+      inline const ServiceRecord& vpnAt(int i) const {return services_list.at(vpn_rows.at(i));}
+      inline QString nickName(const QDBusObjectPath& path) const {return nick_names.value(path.path());}
+
+      // peers
+      inline const ObjectList<arrayElement>& peers() const {return peer_list;}
+      void mergePeers(const QList<arrayElement>&, ChangeSet&);
+      int removePeers(const QList<QDBusObjectPath>&, ChangeSet&);
+
+      // vpn connections (from the vpn manager, used for signals and slots)
+      inline const ObjectList<arrayElement>& vpnConnections() const {return vpnconn_list;}
+      inline void setVPNConnections(const QList<arrayElement>& list) {vpnconn_list.assign(list);}
+
+   private:
+      // members
+      QMap<QString,QVariant> properties_map;
+      ObjectList<TechnologyRecord> technologies_list;
+      ObjectList<ServiceRecord> services_list;
+      ObjectList<arrayElement> peer_list;
+      ObjectList<arrayElement> vpnconn_list;
+      QVector<int> wifi_rows;
+      QVector<int> vpn_rows;
+      QHash<QString,QString> nick_names;
+
+      // functions
+      void reindexServices();
+      QString makeNickName(const ServiceRecord&) const;
+      void merge(ObjectList<arrayElement>&, const QList<arrayElement>&, ChangeSet&);
+      template <class T> void finishMerge(const ObjectList<T>&, const ObjectList<T>&, ChangeSet&) const;
+      template <class T> int remove(ObjectList<T>&, const QList<QDBusObjectPath>&, ChangeSet&) const;
+};
+
+//
+// Function to finish the change set for a merge. Objects in the old list
+// and not in the merged one were removed.  Of the kept objects, the
+// longest run that is still in the old order stays put and every other
+// one moved.  The run is found by patience sorting the old rows in the
+// merged order, O(n log n) in the number of objects.
+template <class T> void ConnmanStore::finishMerge(const ObjectList<T>& oldlist, const ObjectList<T>& merged, ChangeSet& r_changes) const
+{
+   for (int row = 0; row < oldlist.size(); ++row) {
+      if (! merged.contains(oldlist.keys().at(row)) ) r_changes.removed.append(oldlist.keys().at(row) );
+   } // for
+
+   // the kept objects, in the merged order
+   QVector<int> newrows;
+   QVector<int> oldrows;
+   for (int row = 0; row < merged.size(); ++row) {
+      const int oldrow = oldlist.indexOf(merged.keys().at(row) );
+      if (oldrow < 0) continue;
+      newrows.append(row);
+      oldrows.append(oldrow);
+   } // for
+
+   // tails.at(n) is the kept object ending the best run of length n + 1,
+   // prev links each object to the one before it in its run
+   QVector<int> tails;
+   QVector<int> prev(oldrows.size(), -1);
+   for (int i = 0; i < oldrows.size(); ++i) {
+      int lo = 0;
+      int hi = tails.size();
+      while (lo < hi) {
+         const int mid = (lo + hi) / 2;
+         if (oldrows.at(tails.at(mid)) < oldrows.at(i)) lo = mid + 1;
+            else hi = mid;
+      } // while
+      if (lo > 0) prev[i] = tails.at(lo - 1);
+      if (lo == tails.size()) tails.append(i);
+         else tails[lo] = i;
+   } // for
+
+   QVector<bool> stays(oldrows.size(), false);
+   for (int i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = prev.at(i)) {
+      stays[i] = true;
+   } // for
+
+   for (int i = 0; i < oldrows.size(); ++i) {
+      if (stays.at(i) ) continue;
+      ChangeSet::Move mv;
+      mv.path = merged.keys().at(newrows.at(i));
+      mv.from = oldrows.at(i);
+      mv.to = newrows.at(i);
+      r_changes.moved.append(mv);
+   } // for
+
+   return;
+}
+
+//
+// Function to remove objects from a list and record them in the change set.
+// Return the number removed.
+template <class T> int ConnmanStore::remove(ObjectList<T>& list, const QList<QDBusObjectPath>& paths, ChangeSet& r_changes) const
+{
+   for (int i = 0; i < paths.size(); ++i) {
+      if (list.contains(paths.at(i)) ) r_changes.removed.append(paths.at(i).path() );
+   } // for
+
+   return list.remove(paths);
+}
+
+# endif
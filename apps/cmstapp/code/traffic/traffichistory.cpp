@@ -0,0 +1,465 @@
+/**************************** traffichistory.cpp *********************
+
+Traffic of each service kept on disk across sessions.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# include <QDir>
+# include <QFileInfo>
+# include <QSaveFile>
+# include <QTextStream>
+# include <QDateTime>
+# include <QMap>
+# include <QProcessEnvironment>
+
+# include "./traffichistory.h"
+
+// file header
+# define TRAFFIC_MAGIC 0x434d5354
+# define TRAFFIC_VERSION 1
+
+// files in the data directory
+# define RAW_FILE "traffic.raw"
+# define HOURLY_FILE "traffic.hourly"
+# define DAILY_FILE "traffic.daily"
+# define SERVICES_FILE "traffic.services"
+
+// days of hourly buckets kept before they are folded into daily buckets
+# define HOURLY_DAYS 2
+
+// id of the totals of all services added together
+# define ALL_SERVICES 0xffffffff
+
+namespace
+{
+   //
+   // Header at the start of each record file
+   struct FileHeader
+   {
+      quint32 magic;
+      quint16 version;
+      quint16 recsize;
+      quint32 reserved[2];
+   };
+
+   //
+   // Read only memory mapped view of a record file.  A file with a bad
+   // header has no records, a partial record at the end (a crash in the
+   // middle of a write) is ignored.
+   class MappedRecords
+   {
+      public:
+         MappedRecords(const QString& fn) : file(fn), data(NULL), n(0) {
+            if (! file.open(QIODevice::ReadOnly) ) return;
+            const qint64 size = file.size();
+            if (size < static_cast<qint64>(sizeof(FileHeader)) ) return;
+            data = file.map(0, size);
+            if (data == NULL) return;
+            const FileHeader* hdr = reinterpret_cast<const FileHeader*>(data);
+            if (hdr->magic != TRAFFIC_MAGIC || hdr->version != TRAFFIC_VERSION || hdr->recsize != sizeof(TrafficRecord) ) return;
+            n = static_cast<int>((size - sizeof(FileHeader)) / sizeof(TrafficRecord) ); }
+
+         ~MappedRecords() {close();}
+
+         inline int count() const {return n;}
+         inline const TrafficRecord& at(int i) const {return reinterpret_cast<const TrafficRecord*>(data + sizeof(FileHeader))[i];}
+
+         void close() {
+            if (data != NULL) file.unmap(data);
+            data = NULL;
+            n = 0;
+            file.close(); }
+
+      private:
+         QFile file;
+         uchar* data;
+         int n;
+   };
+
+   //
+   // Function to return the header every record file starts with
+   FileHeader fileHeader()
+   {
+      FileHeader hdr;
+      hdr.magic = TRAFFIC_MAGIC;
+      hdr.version = TRAFFIC_VERSION;
+      hdr.recsize = sizeof(TrafficRecord);
+      hdr.reserved[0] = 0;
+      hdr.reserved[1] = 0;
+
+      return hdr;
+   }
+
+   //
+   // Function to return the size of the good part of a record file, the
+   // header and the whole records.  Return -1 if the file is missing or
+   // the header is bad.
+   qint64 validSize(const QString& fn)
+   {
+      QFile file(fn);
+      if (! file.open(QIODevice::ReadOnly) ) return -1;
+
+      FileHeader hdr;
+      const FileHeader good = fileHeader();
+      if (file.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr) ) return -1;
+      if (hdr.magic != good.magic || hdr.version != good.version || hdr.recsize != good.recsize) return -1;
+
+      return sizeof(FileHeader) + (file.size() - sizeof(FileHeader)) / sizeof(TrafficRecord) * sizeof(TrafficRecord);
+   }
+
+   //
+   // Function to return the seconds since the epoch of local midnight
+   // starting a date
+   qint64 localStart(const QDate& date)
+   {
+      return QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch() / 1000;
+   }
+
+   //
+   // Function to return the local date of a time in seconds since the epoch
+   QDate localDate(qint64 secs)
+   {
+      return QDateTime::fromMSecsSinceEpoch(secs * 1000).date();
+   }
+
+   //
+   // Function to add the bytes of a record to the bucket it falls in
+   void addToBucket(QMap<QPair<qint64,quint32>,TrafficRecord>& buckets, qint64 start, const TrafficRecord& rec)
+   {
+      const QPair<qint64,quint32> key(start, rec.service);
+      QMap<QPair<qint64,quint32>,TrafficRecord>::iterator itr = buckets.find(key);
+      if (itr == buckets.end() ) {
+         TrafficRecord bucket = rec;
+         bucket.time = start;
+         bucket.reserved = 0;
+         buckets.insert(key, bucket);
+      }
+      else {
+         itr.value().rx += rec.rx;
+         itr.value().tx += rec.tx;
+      }
+
+      return;
+   }
+} // namespace
+
+// constructor
+TrafficHistory::TrafficHistory()
+{
+   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+   QString HOME = env.value("HOME");
+   QString XDG_DATA_HOME = env.value("XDG_DATA_HOME", QFileInfo(QDir(HOME), ".local/share").absoluteFilePath());
+   dirname = QFileInfo(QDir(XDG_DATA_HOME), "cmst").absoluteFilePath();
+
+   // the service list, one object path per line
+   services.clear();
+   service_ids.clear();
+   last_totals.clear();
+   totals.clear();
+   b_totals = false;
+   QFile file(filePath(SERVICES_FILE) );
+   if (file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+      QTextStream in(&file);
+      while (! in.atEnd() ) {
+         const QString line = in.readLine();
+         service_ids.insert(line, services.count() );
+         services.append(line);
+      } // while
+   } // if
+}
+
+//
+// Function to record a counter sample.  rx and tx are the byte totals from
+// connman, the bytes since the last sample of the same service are
+// appended to the raw log.  The first sample of a service, and any where
+// the totals went backwards because the counters were reset, only set the
+// base.  Return the bytes recorded, received and transmitted together.
+quint64 TrafficHistory::addSample(const QString& path, quint64 rx, quint64 tx)
+{
+   QHash<QString,QPair<quint64,quint64> >::iterator itr = last_totals.find(path);
+   if (itr == last_totals.end() || rx < itr.value().first || tx < itr.value().second) {
+      last_totals.insert(path, qMakePair(rx, tx) );
+      return 0;
+   }
+
+   TrafficRecord rec;
+   rec.time = QDateTime::currentMSecsSinceEpoch() / 1000;
+   rec.reserved = 0;
+   rec.rx = rx - itr.value().first;
+   rec.tx = tx - itr.value().second;
+   itr.value() = qMakePair(rx, tx);
+   if (rec.rx == 0 && rec.tx == 0) return 0;
+
+   rec.service = serviceId(path);
+   if (openRawLog() && rawlog.write(reinterpret_cast<const char*>(&rec), sizeof(rec)) == sizeof(rec) && b_totals)
+      addToTotals(rec);
+
+   return rec.rx + rec.tx;
+}
+
+//
+// Function to fold the raw log into hourly buckets and old hourly buckets
+// into daily buckets.  Only closed hours, and hours more than HOURLY_DAYS
+// old, are moved.  The buckets are appended before the source file is
+// rewritten, a crash in between counts an hour twice rather than losing it.
+// Return false if a file could not be written.
+bool TrafficHistory::compact()
+{
+   const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+   const qint64 cutoff = localStart(QDate::currentDate().addDays(-HOURLY_DAYS) );
+   QMap<QPair<qint64,quint32>,TrafficRecord> buckets;
+   QList<TrafficRecord> keep;
+   bool b_ok = true;
+   bool b_moved = false;
+
+   // raw samples from closed hours into hourly buckets
+   MappedRecords raw(filePath(RAW_FILE) );
+   for (int i = 0; i < raw.count(); ++i) {
+      const TrafficRecord& rec = raw.at(i);
+      if (rec.time >= now - now % 3600) keep.append(rec);
+      else addToBucket(buckets, rec.time - rec.time % 3600, rec);
+   } // for
+   raw.close();
+
+   if (! buckets.isEmpty() ) {
+      rawlog.close();
+      b_ok = appendRecords(HOURLY_FILE, buckets.values() ) && rewriteRecords(RAW_FILE, keep);
+      b_moved = true;
+   } // if
+
+   // old hourly buckets into daily buckets
+   buckets.clear();
+   keep.clear();
+   MappedRecords hourly(filePath(HOURLY_FILE) );
+   for (int i = 0; b_ok && i < hourly.count(); ++i) {
+      const TrafficRecord& rec = hourly.at(i);
+      if (rec.time >= cutoff) keep.append(rec);
+      else addToBucket(buckets, localStart(localDate(rec.time)), rec);
+   } // for
+   hourly.close();
+
+   if (b_ok && ! buckets.isEmpty() ) {
+      b_ok = appendRecords(DAILY_FILE, buckets.values() ) && rewriteRecords(HOURLY_FILE, keep);
+      b_moved = true;
+   } // if
+
+   // if records moved between the files read the totals again when they
+   // are next asked for
+   if (b_moved) {
+      totals.clear();
+      b_totals = false;
+   } // if
+
+   return b_ok;
+}
+
+//
+// Function to return the usage of a service for the last count days or
+// months, oldest first, the current one last.  An empty path adds all
+// services together.  The periods are looked up in the totals, the files
+// are only read the first time and after compact().
+QList<TrafficUsage> TrafficHistory::usage(const QString& path, int period, int count) const
+{
+   QList<TrafficUsage> rtn;
+   if (count <= 0) return rtn;
+
+   // a service we never recorded has no usage
+   const bool b_all = path.isEmpty();
+   if (! b_all && ! service_ids.contains(path) ) return rtn;
+   loadTotals();
+   const Totals tot = totals.value(b_all ? ALL_SERVICES : service_ids.value(path) );
+   const QHash<qint64,QPair<quint64,quint64> >& buckets = period == Period_Month ? tot.months : tot.days;
+
+   // the periods asked for, worked out from today so a new day or month
+   // needs nothing recomputed
+   const QDate today = QDate::currentDate();
+   const QDate first = period == Period_Month ? QDate(today.year(), today.month(), 1).addMonths(1 - count) : today.addDays(1 - count);
+   for (int i = 0; i < count; ++i) {
+      const QDate d = period == Period_Month ? first.addMonths(i) : first.addDays(i);
+      const QPair<quint64,quint64> bytes = buckets.value(period == Period_Month ? d.year() * 12 + d.month() - 1 : d.toJulianDay() );
+      TrafficUsage tu;
+      tu.start = localStart(d);
+      tu.rx = bytes.first;
+      tu.tx = bytes.second;
+      rtn.append(tu);
+   } // for
+
+   return rtn;
+}
+
+//
+// Function to return the bytes, received and transmitted together, a
+// service has used since a time in seconds since the epoch.  The time
+// should be the start of a local day, the totals are kept by day.
+quint64 TrafficHistory::bytesSince(const QString& path, qint64 start) const
+{
+   if (! service_ids.contains(path) ) return 0;
+   loadTotals();
+
+   const qint64 firstday = localDate(start).toJulianDay();
+   const QHash<qint64,QPair<quint64,quint64> > days = totals.value(service_ids.value(path)).days;
+   quint64 rtn = 0;
+   QHashIterator<qint64,QPair<quint64,quint64> > itr(days);
+   while (itr.hasNext()) {
+      itr.next();
+      if (itr.key() >= firstday) rtn += itr.value().first + itr.value().second;
+   } // while
+
+   return rtn;
+}
+
+////////////////////////////////////////////// Private Functions //////////////////////////////////
+//
+// Function to return the full path of a file in the data directory
+QString TrafficHistory::filePath(const char* name) const
+{
+   return QFileInfo(QDir(dirname), QLatin1String(name)).absoluteFilePath();
+}
+
+//
+// Function to return the id of a service, adding it to the service list
+// if it is new
+quint32 TrafficHistory::serviceId(const QString& path)
+{
+   if (service_ids.contains(path) ) return service_ids.value(path);
+
+   const quint32 id = services.count();
+   service_ids.insert(path, id);
+   services.append(path);
+
+   QDir dir(dirname);
+   if (! dir.exists() ) dir.mkpath(dirname);
+   QFile file(filePath(SERVICES_FILE) );
+   if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text) ) {
+      file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+      QTextStream out(&file);
+      out << path << "\n";
+   } // if
+
+   return id;
+}
+
+//
+// Function to open the raw log for appending
+bool TrafficHistory::openRawLog()
+{
+   if (rawlog.isOpen() ) return true;
+   if (! prepareFile(RAW_FILE) ) return false;
+
+   rawlog.setFileName(filePath(RAW_FILE) );
+
+   return rawlog.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered);
+}
+
+//
+// Function to get a file ready for appending.  A missing file or one with
+// a bad header is started over, a partial record at the end is cut off so
+// the next record lines up.
+bool TrafficHistory::prepareFile(const char* name)
+{
+   const qint64 size = validSize(filePath(name) );
+   if (size < 0) return rewriteRecords(name, QList<TrafficRecord>() );
+   if (QFileInfo(filePath(name)).size() > size) return QFile::resize(filePath(name), size);
+
+   return true;
+}
+
+//
+// Function to append records to one of the bucket files
+bool TrafficHistory::appendRecords(const char* name, const QList<TrafficRecord>& recs)
+{
+   if (! prepareFile(name) ) return false;
+
+   QFile file(filePath(name) );
+   if (! file.open(QIODevice::WriteOnly | QIODevice::Append) ) return false;
+   for (int i = 0; i < recs.count(); ++i) {
+      if (file.write(reinterpret_cast<const char*>(&recs.at(i)), sizeof(TrafficRecord)) != sizeof(TrafficRecord) ) return false;
+   } // for
+
+   return true;
+}
+
+//
+// Function to replace one of the files with the header and the records
+// given.  The file is only readable by the user and replaced atomically.
+bool TrafficHistory::rewriteRecords(const char* name, const QList<TrafficRecord>& recs)
+{
+   QDir dir(dirname);
+   if (! dir.exists() && ! dir.mkpath(dirname) ) return false;
+
+   QSaveFile file(filePath(name) );
+   if (! file.open(QIODevice::WriteOnly) ) return false;
+   file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+   const FileHeader hdr = fileHeader();
+   file.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr) );
+   for (int i = 0; i < recs.count(); ++i) {
+      file.write(reinterpret_cast<const char*>(&recs.at(i)), sizeof(TrafficRecord) );
+   } // for
+
+   return file.commit();
+}
+
+//
+// Function to read the daily, hourly and raw files into the totals.  Does
+// nothing if they are already read, addSample() keeps them current.
+void TrafficHistory::loadTotals() const
+{
+   if (b_totals) return;
+   totals.clear();
+
+   const char* files[] = {DAILY_FILE, HOURLY_FILE, RAW_FILE};
+   for (uint f = 0; f < sizeof(files) / sizeof(files[0]); ++f) {
+      MappedRecords mr(filePath(files[f]) );
+      for (int i = 0; i < mr.count(); ++i) {
+         addToTotals(mr.at(i) );
+      } // for records
+   } // for files
+   b_totals = true;
+
+   return;
+}
+
+//
+// Function to add a record to the day and month it falls in, for its
+// service and for all services
+void TrafficHistory::addToTotals(const TrafficRecord& rec) const
+{
+   const QDate d = localDate(rec.time);
+   const qint64 day = d.toJulianDay();
+   const qint64 month = d.year() * 12 + d.month() - 1;
+   const quint32 ids[] = {rec.service, ALL_SERVICES};
+
+   for (uint i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i) {
+      Totals& tot = totals[ids[i]];
+      QPair<quint64,quint64>& dp = tot.days[day];
+      dp.first += rec.rx;
+      dp.second += rec.tx;
+      QPair<quint64,quint64>& mp = tot.months[month];
+      mp.first += rec.rx;
+      mp.second += rec.tx;
+   } // for
+
+   return;
+}
@@ -0,0 +1,109 @@
+/**************************** traffichistory.h ***********************
+
+Traffic of each service kept on disk across sessions.  Counter samples
+are appended to a raw log, compaction folds closed hours into hourly
+buckets and old hours into daily buckets.  All three files hold fixed
+size records and are memory mapped to read, so a usage query is a
+single pass over the buckets.
+
+Copyright (C) 2013-2022
+by: Andrew J. Bibb
+License: MIT
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"),to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+# ifndef TRAFFIC_HISTORY_H
+# define TRAFFIC_HISTORY_H
+
+# include <QString>
+# include <QStringList>
+# include <QHash>
+# include <QList>
+# include <QFile>
+# include <QPair>
+
+//
+// One record in any of the files.  In the raw log time is when the sample
+// was taken and rx/tx the bytes since the sample before it.  In the bucket
+// files time is the start of the hour or the local day and rx/tx the sum.
+struct TrafficRecord
+{
+   qint64 time;         // seconds since the epoch
+   quint32 service;     // line in the service list
+   quint32 reserved;
+   quint64 rx;
+   quint64 tx;
+};
+
+//
+// Usage of one day or month returned by a query
+struct TrafficUsage
+{
+   qint64 start;        // seconds since the epoch of the local start of the period
+   quint64 rx;
+   quint64 tx;
+};
+
+class TrafficHistory
+{
+   public:
+      enum Period {
+         Period_Day = 0,
+         Period_Month = 1
+      };
+
+      TrafficHistory();
+
+      quint64 addSample(const QString&, quint64, quint64);
+      bool compact();
+      QList<TrafficUsage> usage(const QString&, int, int) const;
+      quint64 bytesSince(const QString&, qint64) const;
+      inline const QString& directory() const {return dirname;}
+
+   private:
+      // Totals of one service, rx and tx keyed by julian day and by month
+      // number (year * 12 + month - 1)
+      struct Totals
+      {
+         QHash<qint64,QPair<quint64,quint64> > days;
+         QHash<qint64,QPair<quint64,quint64> > months;
+      };
+
+      // members
+      QString dirname;
+      QStringList services;               // object paths, the index is the id in the records
+      QHash<QString,quint32> service_ids;
+      QHash<QString,QPair<quint64,quint64> > last_totals;
+      QFile rawlog;
+      mutable QHash<quint32,Totals> totals;  // by service id, ALL_SERVICES for all of them
+      mutable bool b_totals;                 // totals are read from the files
+
+      // functions
+      QString filePath(const char*) const;
+      quint32 serviceId(const QString&);
+      bool openRawLog();
+      bool prepareFile(const char*);
+      bool appendRecords(const char*, const QList<TrafficRecord>&);
+      bool rewriteRecords(const char*, const QList<TrafficRecord>&);
+      void loadTotals() const;
+      void addToTotals(const TrafficRecord&) const;
+};
+
+# endif
@@ -46,6 +46,9 @@ DEALINGS IN THE SOFTWARE.
 # define ERROR_RETRY "net.connman.vpn.Agent.Error.Retry"
 # define ERROR_CANCELED "net.connman.vpn.Agent.Error.Canceled"
 
+// how long a request waits for the user, the connman-vpn default
+# define INPUT_TIMEOUT (120 * 1000)
+
 //  constructor
 ConnmanVPNAgent::ConnmanVPNAgent(QObject* parent)
     : QObject(parent)
@@ -58,6 +61,8 @@ ConnmanVPNAgent::ConnmanVPNAgent(QObject* parent)
    allowRetrieveCredentials = false;
    keepCredentials = false;
    authFailure = QString();
+   requests.clear();
+   connect(uiDialog, SIGNAL(finished(int)), this, SLOT(dialogFinished(int)));
 
    //  Create Adaptor and register this Agent on the system bus.
    new VPNAgentAdaptor(this);
@@ -78,24 +83,30 @@ void ConnmanVPNAgent::Release()
 }
 
 // Called when an error has to be reported to the user.  Show the
-// error in a QMessageBox
+// error in a QMessageBox.  The box is not modal and the reply is delayed
+// until the user answers it, see errorFinished().
 void ConnmanVPNAgent::ReportError(QDBusObjectPath path, QString s_error)
 {
   (void) path;
 
-  if ( QMessageBox::warning(qobject_cast<QWidget *> (parent()), tr("Connman Error"),
+  this->setDelayedReply(true);
+  QMessageBox* mbox = new QMessageBox(QMessageBox::Warning, tr("Connman Error"),
     tr("Connman returned the following error:<b><center>%1</b><br>Would you like to retry?").arg(TranslateStrings::cmtr(s_error)),
-    QMessageBox::Yes | QMessageBox::No,
-    QMessageBox::No
-     ) == QMessageBox::Yes) this->sendErrorReply(ERROR_RETRY, "Going to retry the request");
+    QMessageBox::Yes | QMessageBox::No, qobject_cast<QWidget *> (parent()) );
+  mbox->setDefaultButton(QMessageBox::No);
+  mbox->setAttribute(Qt::WA_DeleteOnClose);
+  errors.insert(mbox, this->message() );
+  connect(mbox, SIGNAL(finished(int)), this, SLOT(errorFinished(int)));
+  mbox->show();
 
-  else  return;
+  return;
 }
 
 
 //
 // Called when trying to connect to a service and some extra input is required from the user
 // A dialog is displayed with the required fields enabled (non-required fields are disabled).
+// The reply is delayed until the user closes the dialog, see dialogFinished().
 QVariantMap ConnmanVPNAgent::RequestInput(QDBusObjectPath path, QMap<QString,QVariant> dict)
 {
   (void) path;
@@ -103,25 +114,32 @@ QVariantMap ConnmanVPNAgent::RequestInput(QDBusObjectPath path, QMap<QString,QVa
   // Take the dict returned by DBus and extract the information we are interested in and place in input_map.
   this->createInputMap(dict);
 
-  // Send our input_map to the dialog to have the user supply the necessary information
-  // needed to continue.  Return if canceled.
-  QMap<QString,QVariant> rtn;
-  rtn.clear();
-  if (this->uiDialog->showPage(input_map) == QDialog::Rejected)
-    this->sendErrorReply(ERROR_CANCELED,"User cancelled the dialog");
-  else
-    uiDialog->createDict(rtn);  // create a return dict and send it back to connman on DBus
+  VPNAgentRequest req;
+  req.input = input_map;
+  this->queueRequest(req, INPUT_TIMEOUT);
 
-  return rtn;
+  return QVariantMap();
 }
 
 //
-// Called when the agent request failed before a reply was returned. Show
-// a QMessageBox
+// Called when the agent request failed before a reply was returned.  Close
+// the dialog and show a QMessageBox
 void ConnmanVPNAgent::Cancel()
 {
-  QMessageBox::information(qobject_cast<QWidget *> (parent()), tr("Agent Request Failed"),
-    tr("The agent request failed before a reply was returned.") );
+  // connman-vpn has already dropped the request, so it gets no reply. Hiding
+  // the dialog does not emit finished(), dialogFinished() is not called.
+  if (! requests.isEmpty() ) {
+    VPNAgentRequest req = requests.takeFirst();
+    req.timer->stop();
+    req.timer->deleteLater();
+    uiDialog->hide();
+    this->showRequest();
+  } // if a request is showing
+
+  QMessageBox* mbox = new QMessageBox(QMessageBox::Information, tr("Agent Request Failed"),
+    tr("The agent request failed before a reply was returned."), QMessageBox::Ok, qobject_cast<QWidget *> (parent()) );
+  mbox->setAttribute(Qt::WA_DeleteOnClose);
+  mbox->show();
 
   return;
 }
@@ -203,4 +221,98 @@ void ConnmanVPNAgent::createInputMap(const QMap<QString,QVariant>& r_map)
   return;
 }
 
+/////////////////////////////////////// PRIVATE FUNCTIONS ////////////////////////////////
+//
+// Function to take over the DBus message being handled and queue the
+// request.  Requests are shown one at a time in the order they arrived.
+void ConnmanVPNAgent::queueRequest(VPNAgentRequest& req, int timeout)
+{
+   this->setDelayedReply(true);
+   req.msg = this->message();
+   req.timer = new QTimer(this);
+   req.timer->setSingleShot(true);
+   connect(req.timer, SIGNAL(timeout()), this, SLOT(requestTimedOut()));
+   req.timer->start(timeout);
+
+   requests.append(req);
+   if (requests.count() == 1) this->showRequest();
+
+   return;
+}
+
+//
+// Function to show the dialog for the request at the head of the queue
+void ConnmanVPNAgent::showRequest()
+{
+   if (requests.isEmpty() ) return;
+
+   uiDialog->showPage(requests.first().input);
+
+   return;
+}
+
+/////////////////////////////////////// PRIVATE SLOTS ////////////////////////////////
+//
+// Slot called when the dialog is closed.  Send the reply for the request
+// at the head of the queue and show the next one.
+void ConnmanVPNAgent::dialogFinished(int result)
+{
+   if (requests.isEmpty() ) return;
+   VPNAgentRequest req = requests.takeFirst();
+   req.timer->deleteLater();
+
+   QDBusMessage reply;
+   if (result == QDialog::Rejected)
+      reply = req.msg.createErrorReply(ERROR_CANCELED, "User cancelled the dialog");
+   else {
+      QMap<QString,QVariant> rtn;
+      uiDialog->createDict(rtn);  // create a return dict and send it back to connman on DBus
+      reply = req.msg.createReply(QVariant(rtn) );
+   } // else
+   QDBusConnection::systemBus().send(reply);
+
+   this->showRequest();
+
+   return;
+}
+
+//
+// Slot called when a request has waited too long.  If it is showing close
+// the dialog, otherwise just drop it.
+void ConnmanVPNAgent::requestTimedOut()
+{
+   QTimer* timer = qobject_cast<QTimer*>(sender() );
+   for (int i = 0; i < requests.count(); ++i) {
+      if (requests.at(i).timer != timer) continue;
+      if (i == 0) {
+         uiDialog->reject();
+      }
+      else {
+         QDBusConnection::systemBus().send(requests.at(i).msg.createErrorReply(ERROR_CANCELED, "Request timed out") );
+         timer->deleteLater();
+         requests.removeAt(i);
+      }
+      break;
+   } // for
+
+   return;
+}
+
+//
+// Slot called when the user answers an error box.  Ask connman-vpn to
+// retry if the user said yes, otherwise just acknowledge the error.
+void ConnmanVPNAgent::errorFinished(int result)
+{
+   (void) result;
 
+   QMessageBox* mbox = qobject_cast<QMessageBox*>(sender() );
+   if (! errors.contains(mbox) ) return;
+   const QDBusMessage msg = errors.take(mbox);
+
+   if (mbox->standardButton(mbox->clickedButton()) == QMessageBox::Yes)
+      QDBusConnection::systemBus().send(msg.createErrorReply(ERROR_RETRY, "Going to retry the request") );
+   else
+      QDBusConnection::systemBus().send(msg.createReply() );
+
+   return;
+}
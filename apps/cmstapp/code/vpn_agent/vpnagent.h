@@ -37,6 +37,11 @@ DEALINGS IN THE SOFTWARE.
 # include <QVariantMap>
 # include <QtDBus/QDBusObjectPath>
 # include <QtDBus/QDBusContext>
+# include <QtDBus/QDBusMessage>
+# include <QList>
+# include <QHash>
+# include <QTimer>
+# include <QMessageBox>
 
 # include "./code/vpn_agent/vpnagent_dialog.h"
 
@@ -44,6 +49,15 @@ DEALINGS IN THE SOFTWARE.
 # define VPN_AGENT_INTERFACE "net.connman.vpn.Agent"
 # define VPN_AGENT_OBJECT "/org/cmst/VPNAgent"
 
+//
+// A request from connman-vpn waiting for the user
+struct VPNAgentRequest
+{
+   QDBusMessage msg;
+   QMap<QString,QString> input;
+   QTimer* timer;
+};
+
 class ConnmanVPNAgent : public QObject, protected QDBusContext
 {
    Q_OBJECT
@@ -68,7 +82,15 @@ class ConnmanVPNAgent : public QObject, protected QDBusContext
       bool allowRetrieveCredentials;
       bool keepCredentials;
       QString authFailure;
-
+      QList<VPNAgentRequest> requests;
+      QHash<QMessageBox*, QDBusMessage> errors;
+      void queueRequest(VPNAgentRequest&, int);
+      void showRequest();
+
+   private slots:
+      void dialogFinished(int);
+      void requestTimedOut();
+      void errorFinished(int);
 
    public:
       inline void setWhatsThisIcon(QIcon icon) {uiDialog->setWhatsThisIcon(icon);}
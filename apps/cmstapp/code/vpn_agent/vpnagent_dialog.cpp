@@ -115,8 +115,9 @@ void VPNAgentDialog::createDict(QMap<QString,QVariant>& r_map)
 //
 // Function to show the dialog.
 // imap - is map of QStrings with input keys that connman has requested the user to fill in, and any values
-// that it has sent back for informational purposes.  Return the accept state of the dialog
-int VPNAgentDialog::showPage(const QMap<QString,QString>& imap)
+// that it has sent back for informational purposes.  The dialog is not modal, the result
+// comes back with the finished() signal.
+void VPNAgentDialog::showPage(const QMap<QString,QString>& imap)
 {
    // set all input widgets to disabled
    this->initialize();
@@ -183,7 +184,11 @@ int VPNAgentDialog::showPage(const QMap<QString,QString>& imap)
       ui.lineEdit_ov_privatekeypassword->setText(imap.value("OpenVPN.PrivateKeyPassword") );
    }
 
-   return this->exec();
+   this->show();
+   this->raise();
+   this->activateWindow();
+
+   return;
 }
 
 ///////////////////////////////////////////////// Private Functions /////////////////////////////////////////////
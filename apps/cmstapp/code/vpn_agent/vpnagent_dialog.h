@@ -48,7 +48,7 @@ class VPNAgentDialog : public QDialog
 
       // functions
       void createDict(QMap<QString,QVariant>&);
-      int showPage(const QMap<QString,QString>&);
+      void showPage(const QMap<QString,QString>&);
 
    private:
       // members
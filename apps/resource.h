@@ -107,6 +107,18 @@ namespace CMST
     ValDialog_46cidr   = 0x0f,
     ValDialog_networks = 0x10,
 
+    // display pages that need to be rebuilt by the redraw scheduler
+    Page_None        = 0x00,
+    Page_Status      = (1 << 0),
+    Page_Details     = (1 << 1),
+    Page_Wireless    = (1 << 2),
+    Page_VPN         = (1 << 3),
+    Page_Counters    = (1 << 4),
+    Page_Preferences = (1 << 5),
+    Page_TrayIcon    = (1 << 6),
+    Page_Services    = 0x6f,  // every page showing something from the services list
+    Page_All         = 0x7f,
+
   };  // enum
 } // namespace CMST
 